@@ -0,0 +1,299 @@
+#pragma once
+
+/* Goal-directed point-to-point router. A* search ordered by route key plus lower bound
+ * of the key left to the destination. The bound is the maximum of external heuristic
+ * (e.g. geographic distance / max velocity) and ALT landmark bounds: keys from and to
+ * a few landmark vertices are precomputed, so by triangle inequality
+ * d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L).
+ * Labels are thread_local workspace rather than router members, so concurrent queries don't share them.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class AStarRouter;
+
+template <typename Weight>
+struct AStarInternalState {
+    const std::vector<VertexId>& landmarks;
+    const std::vector<double>& from_landmarks;      /* index = landmark index * vertex_count + vertex */
+    const std::vector<double>& to_landmarks;
+};
+
+template <typename Weight>
+class AStarRouter {
+    static_assert(WeightTraits<Weight>::HAS_SCALAR_KEY, "A* router needs weights with scalar key");
+
+public:
+    using Graph = CsrGraph<Weight>;
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+    /* lower bound of route key from first vertex to second one, must not overestimate */
+    using Heuristic = std::function<double(VertexId from, VertexId to)>;
+
+    /* landmark_count - number of ALT landmarks to precompute (0 - heuristic only) */
+    explicit AStarRouter(const Graph& graph, size_t landmark_count = 0, Heuristic heuristic = nullptr);
+
+    /* heuristic is not a part of internal state and is set after external initialization */
+    void SetHeuristic(Heuristic heuristic);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    const AStarInternalState<Weight> ExportInternalState() const;
+    void ExternalInitialization(std::vector<VertexId>&& landmarks,
+                                std::vector<double>&& from_landmarks,
+                                std::vector<double>&& to_landmarks);
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+    /* flat per-vertex search labels, reused between queries of the thread */
+    struct SearchLabels {
+        std::vector<double> keys;
+        std::vector<EdgeId> prev_edges;
+        std::vector<VertexId> reached_vertexes;     /* vertexes with finite key, for reset */
+    };
+
+    /* Labels of calling thread with keys of previous query reset, sized to the graph */
+    SearchLabels& GetSearchLabels() const;
+
+    /* Dijkstra keys from source, backward - over reversed edges */
+    std::vector<double> ComputeKeys(VertexId source, const std::vector<size_t>& reversed_offsets,
+                                    const std::vector<EdgeId>& reversed_edges, bool backward) const;
+    void SelectLandmarks(size_t landmark_count);
+    double GetLowerBound(VertexId vertex, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Heuristic heuristic_;
+    std::vector<VertexId> landmarks_;
+    std::vector<double> from_landmarks_;
+    std::vector<double> to_landmarks_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, size_t landmark_count, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    SelectLandmarks(landmark_count);
+}
+
+template <typename Weight>
+void AStarRouter<Weight>::SetHeuristic(Heuristic heuristic) {
+    heuristic_ = std::move(heuristic);
+}
+
+template <typename Weight>
+std::vector<double> AStarRouter<Weight>::ComputeKeys(VertexId source,
+                                                     const std::vector<size_t>& reversed_offsets,
+                                                     const std::vector<EdgeId>& reversed_edges,
+                                                     bool backward) const {
+    std::vector<double> keys(graph_.GetVertexCount(), INF);
+    keys[source] = 0;
+
+    using QueueItem = std::pair<double, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({0, source});
+
+    auto relax = [&](double key, EdgeId edge_id, VertexId next) {
+        const double candidate = key + WeightTraits<Weight>::GetKey(graph_.GetEdge(edge_id).weight);
+        if (candidate < keys[next]) {
+            keys[next] = candidate;
+            queue.push({candidate, next});
+        }
+    };
+
+    while (!queue.empty()) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (keys[vertex] < key) continue;   // outdated queue item
+
+        if (backward) {
+            for (size_t i = reversed_offsets[vertex]; i < reversed_offsets[vertex + 1]; ++i) {
+                relax(key, reversed_edges[i], graph_.GetEdge(reversed_edges[i]).from);
+            }
+        } else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(key, edge_id, graph_.GetEdge(edge_id).to);
+            }
+        }
+    }
+    return keys;
+}
+
+/* Farthest landmarks selection: every next landmark is the vertex farthest
+   from already selected ones, vertexes unreachable from them go first */
+template <typename Weight>
+void AStarRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    landmarks_.clear();
+    from_landmarks_.clear();
+    to_landmarks_.clear();
+    landmark_count = std::min(landmark_count, vertex_count);
+    if (landmark_count == 0) return;
+
+    // reversed edges in CSR layout
+    std::vector<size_t> reversed_offsets(vertex_count + 1, 0);
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        ++reversed_offsets[graph_.GetEdge(edge_id).to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        reversed_offsets[vertex + 1] += reversed_offsets[vertex];
+    }
+    std::vector<EdgeId> reversed_edges(edge_count);
+    std::vector<size_t> fill(reversed_offsets.begin(), reversed_offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        reversed_edges[fill[graph_.GetEdge(edge_id).to]++] = edge_id;
+    }
+
+    // start from the vertex farthest from vertex 0
+    std::vector<double> min_keys = ComputeKeys(0, reversed_offsets, reversed_edges, false);
+    for (double& key : min_keys) {
+        if (key == INF) key = 0;
+    }
+    for (size_t i = 0; i < landmark_count; ++i) {
+        const VertexId landmark = std::max_element(min_keys.begin(), min_keys.end()) - min_keys.begin();
+        landmarks_.push_back(landmark);
+
+        std::vector<double> from_keys = ComputeKeys(landmark, reversed_offsets, reversed_edges, false);
+        std::vector<double> to_keys = ComputeKeys(landmark, reversed_offsets, reversed_edges, true);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            min_keys[vertex] = (i == 0) ? from_keys[vertex] : std::min(min_keys[vertex], from_keys[vertex]);
+        }
+        min_keys[landmark] = 0;
+        from_landmarks_.insert(from_landmarks_.end(), from_keys.begin(), from_keys.end());
+        to_landmarks_.insert(to_landmarks_.end(), to_keys.begin(), to_keys.end());
+    }
+}
+
+template <typename Weight>
+double AStarRouter<Weight>::GetLowerBound(VertexId vertex, VertexId to) const {
+    double bound = heuristic_ ? heuristic_(vertex, to) : 0;
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (size_t i = 0; i < landmarks_.size(); ++i) {
+        const double* from_landmark = from_landmarks_.data() + i * vertex_count;
+        const double* to_landmark = to_landmarks_.data() + i * vertex_count;
+        // landmark reaches vertex but not destination, or destination reaches landmark but vertex doesn't
+        if (from_landmark[vertex] != INF) {
+            if (from_landmark[to] == INF) return INF;
+            bound = std::max(bound, from_landmark[to] - from_landmark[vertex]);
+        }
+        if (to_landmark[to] != INF) {
+            if (to_landmark[vertex] == INF) return INF;
+            bound = std::max(bound, to_landmark[vertex] - to_landmark[to]);
+        }
+    }
+    return bound;
+}
+
+/* Labels are shared by routers of all graphs used in the thread, so they only grow. Keys are reset
+   before the query, not after, so labels left by a query interrupted with exception are reset too */
+template <typename Weight>
+typename AStarRouter<Weight>::SearchLabels& AStarRouter<Weight>::GetSearchLabels() const {
+    thread_local SearchLabels labels;
+    for (const VertexId vertex : labels.reached_vertexes) {
+        labels.keys[vertex] = INF;
+    }
+    labels.reached_vertexes.clear();
+    if (labels.keys.size() < graph_.GetVertexCount()) {
+        labels.keys.resize(graph_.GetVertexCount(), INF);
+        labels.prev_edges.resize(graph_.GetVertexCount());
+    }
+    return labels;
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of graph");
+    }
+    SearchLabels& labels = GetSearchLabels();
+    std::vector<double>& keys = labels.keys;
+    std::vector<EdgeId>& prev_edges = labels.prev_edges;
+
+    /* estimated route key, key, vertex */
+    using QueueItem = std::tuple<double, double, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    keys[from] = 0;
+    labels.reached_vertexes.push_back(from);
+    queue.push({GetLowerBound(from, to), 0, from});
+
+    bool found = false;
+    while (!queue.empty()) {
+        const auto [estimate, key, vertex] = queue.top();
+        queue.pop();
+        if (keys[vertex] < key) continue;       // outdated queue item
+        if (vertex == to) {
+            found = true;
+            break;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const double candidate = key + WeightTraits<Weight>::GetKey(edge.weight);
+            if (candidate < keys[edge.to]) {
+                const double bound = GetLowerBound(edge.to, to);
+                if (bound == INF) continue;     // destination is unreachable
+                if (keys[edge.to] == INF) labels.reached_vertexes.push_back(edge.to);
+                keys[edge.to] = candidate;
+                prev_edges[edge.to] = edge_id;
+                queue.push({candidate + bound, candidate, edge.to});
+            }
+        }
+    }
+
+    if (!found) return std::nullopt;
+
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(prev_edges[vertex]).from) {
+        edges.push_back(prev_edges[vertex]);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+inline const AStarInternalState<Weight> AStarRouter<Weight>::ExportInternalState() const {
+    return AStarInternalState<Weight>{landmarks_, from_landmarks_, to_landmarks_};
+}
+
+template <typename Weight>
+inline void AStarRouter<Weight>::ExternalInitialization(std::vector<VertexId>&& landmarks,
+                                                        std::vector<double>&& from_landmarks,
+                                                        std::vector<double>&& to_landmarks) {
+    const size_t size = landmarks.size() * graph_.GetVertexCount();
+    if (from_landmarks.size() != size || to_landmarks.size() != size) {
+        throw std::invalid_argument("Landmarks keys size doesn't match graph");
+    }
+    landmarks_ = std::move(landmarks);
+    from_landmarks_ = std::move(from_landmarks);
+    to_landmarks_ = std::move(to_landmarks);
+}
+
+}  // namespace graph
@@ -0,0 +1,425 @@
+#pragma once
+
+/* Contraction hierarchies router.
+ * Preprocessing contracts vertices one by one in order of importance and adds shortcut edges
+ * that keep shortest paths between remaining vertices. Query runs bidirectional Dijkstra
+ * over edges going upward in the hierarchy and unpacks shortcuts into original graph edges.
+ * Searches relax route keys only, shortcuts keep full weights for the stored hierarchy.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/* Shortcut edge, replaces path first_edge -> second_edge through contracted vertex.
+   Edges ids: [0, edge_count) - graph edges, [edge_count, ...) - shortcuts */
+template <typename Weight>
+struct Shortcut {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+    EdgeId first_edge;
+    EdgeId second_edge;
+};
+
+template <typename Weight>
+class ContractionHierarchy;
+
+template <typename Weight>
+struct ContractionHierarchyInternalState {
+    const std::vector<size_t>& vertex_ranks;
+    const std::vector<Shortcut<Weight>>& shortcuts;
+};
+
+template <typename Weight>
+class ContractionHierarchy {
+public:
+    using Graph = CsrGraph<Weight>;
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    const ContractionHierarchyInternalState<Weight> ExportInternalState() const;
+    void ExternalInitialization(std::vector<size_t>&& vertex_ranks,
+                                std::vector<Shortcut<Weight>>&& shortcuts);
+
+private:
+    using Key = RouteKey<Weight>;
+
+    /* edges between not yet contracted vertices, key = adjacent vertex, data = route key and edge */
+    using Adjacency = std::unordered_map<VertexId, std::pair<Key, EdgeId>>;
+
+    struct SearchLabel {
+        Key key;
+        std::optional<EdgeId> prev_edge;
+    };
+    using SearchLabels = std::unordered_map<VertexId, SearchLabel>;
+
+    void Contract();
+    std::vector<Shortcut<Weight>> FindShortcuts(VertexId vertex, size_t settle_limit) const;
+    std::unordered_map<VertexId, Key> FindWitnesses(VertexId from, VertexId excluded_vertex,
+                                                    const Key& max_key, size_t settle_limit) const;
+    void BuildSearchGraph();
+
+    VertexId GetEdgeFrom(EdgeId edge_id) const;
+    VertexId GetEdgeTo(EdgeId edge_id) const;
+    const Weight& GetEdgeWeight(EdgeId edge_id) const;
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Key ZERO_KEY{};
+    static constexpr size_t WITNESS_SEARCH_SETTLE_LIMIT = 500;
+    static constexpr size_t PRIORITY_WITNESS_SEARCH_SETTLE_LIMIT = 20;  /* cheap estimate of shortcuts count */
+
+    const Graph& graph_;
+    std::vector<size_t> vertex_ranks_;              // index = vertex_id, data = contraction order
+    std::vector<Shortcut<Weight>> shortcuts_;       // index = edge_id - graph edge count
+    std::vector<std::vector<EdgeId>> upward_edges_;     // index = vertex_id, edges to higher ranked vertices
+    std::vector<std::vector<EdgeId>> downward_edges_;   // index = vertex_id, edges from higher ranked vertices
+
+    /* preprocessing state */
+    std::vector<Adjacency> out_edges_;
+    std::vector<Adjacency> in_edges_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+{
+    Contract();
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    out_edges_.assign(vertex_count, {});
+    in_edges_.assign(vertex_count, {});
+
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if (edge.from == edge.to) continue;
+        const Key key = GetRouteKey(edge.weight);
+        auto it = out_edges_[edge.from].find(edge.to);
+        if (it == out_edges_[edge.from].end() || key < it->second.first) {
+            out_edges_[edge.from][edge.to] = {key, edge_id};
+            in_edges_[edge.to][edge.from] = {key, edge_id};
+        }
+    }
+
+    /* priority = edge difference + contracted neighbors, lower contracts first */
+    std::vector<int> contracted_neighbors(vertex_count, 0);
+    auto priority = [&](VertexId vertex) {
+        return static_cast<int>(FindShortcuts(vertex, PRIORITY_WITNESS_SEARCH_SETTLE_LIMIT).size())
+             - static_cast<int>(in_edges_[vertex].size() + out_edges_[vertex].size())
+             + contracted_neighbors[vertex];
+    };
+
+    using QueueItem = std::pair<int, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({priority(vertex), vertex});
+    }
+
+    vertex_ranks_.assign(vertex_count, 0);
+    shortcuts_.clear();
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        // lazy update: contract only if vertex is still the least important
+        const int current_priority = priority(vertex);
+        if (!queue.empty() && current_priority > queue.top().first) {
+            queue.push({current_priority, vertex});
+            continue;
+        }
+
+        vertex_ranks_[vertex] = rank++;
+        for (auto& shortcut : FindShortcuts(vertex, WITNESS_SEARCH_SETTLE_LIMIT)) {
+            const EdgeId shortcut_id = edge_count + shortcuts_.size();
+            const Key key = GetRouteKey(shortcut.weight);
+            auto it = out_edges_[shortcut.from].find(shortcut.to);
+            if (it == out_edges_[shortcut.from].end() || key < it->second.first) {
+                out_edges_[shortcut.from][shortcut.to] = {key, shortcut_id};
+                in_edges_[shortcut.to][shortcut.from] = {key, shortcut_id};
+            }
+            shortcuts_.push_back(std::move(shortcut));
+        }
+
+        // remove contracted vertex from the remaining graph
+        for (const auto& [neighbor, data] : in_edges_[vertex]) {
+            out_edges_[neighbor].erase(vertex);
+            ++contracted_neighbors[neighbor];
+        }
+        for (const auto& [neighbor, data] : out_edges_[vertex]) {
+            in_edges_[neighbor].erase(vertex);
+            ++contracted_neighbors[neighbor];
+        }
+        Adjacency{}.swap(in_edges_[vertex]);
+        Adjacency{}.swap(out_edges_[vertex]);
+    }
+
+    out_edges_.clear();
+    in_edges_.clear();
+}
+
+template <typename Weight>
+std::vector<Shortcut<Weight>> 
+ContractionHierarchy<Weight>::FindShortcuts(VertexId vertex, size_t settle_limit) const {
+    std::vector<Shortcut<Weight>> result;
+    for (const auto& [from, in_data] : in_edges_[vertex]) {
+        // max key of path through vertex limits witness search
+        std::optional<Key> max_key;
+        for (const auto& [to, out_data] : out_edges_[vertex]) {
+            if (to == from) continue;
+            const Key key = in_data.first + out_data.first;
+            if (!max_key || *max_key < key) max_key = key;
+        }
+        if (!max_key) continue;
+
+        const auto witnesses = FindWitnesses(from, vertex, *max_key, settle_limit);
+        for (const auto& [to, out_data] : out_edges_[vertex]) {
+            if (to == from) continue;
+            const Key key = in_data.first + out_data.first;
+            auto it = witnesses.find(to);
+            if (it != witnesses.end() && !(key < it->second)) continue;    // witness path is not longer
+            result.push_back(Shortcut<Weight>{from, to,
+                                              GetEdgeWeight(in_data.second) + GetEdgeWeight(out_data.second),
+                                              in_data.second, out_data.second});
+        }
+    }
+    return result;
+}
+
+/* Limited Dijkstra in remaining graph avoiding excluded vertex */
+template <typename Weight>
+std::unordered_map<VertexId, typename ContractionHierarchy<Weight>::Key> ContractionHierarchy<Weight>::FindWitnesses
+            (VertexId from, VertexId excluded_vertex, const Key& max_key, size_t settle_limit) const {
+    std::unordered_map<VertexId, Key> distances{{from, ZERO_KEY}};
+
+    using QueueItem = std::pair<Key, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.first > rhs.first;
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)> queue(greater);
+    queue.push({ZERO_KEY, from});
+
+    size_t settled = 0;
+    while (!queue.empty() && settled < settle_limit) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (distances.at(vertex) < key) continue;       // outdated queue item
+        if (max_key < key) break;
+        ++settled;
+
+        for (const auto& [to, data] : out_edges_[vertex]) {
+            if (to == excluded_vertex) continue;
+            const Key candidate_key = key + data.first;
+            auto it = distances.find(to);
+            if (it == distances.end() || candidate_key < it->second) {
+                distances[to] = candidate_key;
+                queue.push({candidate_key, to});
+            }
+        }
+    }
+    return distances;
+}
+
+/* Split graph edges and shortcuts into upward and downward search graphs by vertex ranks */
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraph() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    upward_edges_.assign(vertex_count, {});
+    downward_edges_.assign(vertex_count, {});
+
+    auto add_edge = [this](EdgeId edge_id) {
+        const VertexId from = GetEdgeFrom(edge_id);
+        const VertexId to = GetEdgeTo(edge_id);
+        if (vertex_ranks_[from] < vertex_ranks_[to]) {
+            upward_edges_[from].push_back(edge_id);
+        } else {
+            downward_edges_[to].push_back(edge_id);
+        }
+    };
+
+    // only the lightest of parallel graph edges is needed
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        std::unordered_map<VertexId, EdgeId> lightest_edges;
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.to == vertex) continue;
+            auto it = lightest_edges.find(edge.to);
+            if (it == lightest_edges.end()) {
+                lightest_edges[edge.to] = edge_id;
+            } else if (edge.weight < graph_.GetEdge(it->second).weight) {
+                it->second = edge_id;
+            }
+        }
+        for (const auto& [to, edge_id] : lightest_edges) {
+            add_edge(edge_id);
+        }
+    }
+
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (size_t i = 0; i < shortcuts_.size(); ++i) {
+        add_edge(edge_count + i);
+    }
+}
+
+template <typename Weight>
+VertexId ContractionHierarchy<Weight>::GetEdgeFrom(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdge(edge_id).from : shortcuts_[edge_id - edge_count].from;
+}
+
+template <typename Weight>
+VertexId ContractionHierarchy<Weight>::GetEdgeTo(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdge(edge_id).to : shortcuts_[edge_id - edge_count].to;
+}
+
+template <typename Weight>
+const Weight& ContractionHierarchy<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdge(edge_id).weight : shortcuts_[edge_id - edge_count].weight;
+}
+
+/* Replace shortcut by graph edges it consists of */
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < edge_count) {
+            edges.push_back(current);
+        } else {
+            const auto& shortcut = shortcuts_[current - edge_count];
+            stack.push_back(shortcut.second_edge);
+            stack.push_back(shortcut.first_edge);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= upward_edges_.size() || to >= upward_edges_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    using QueueItem = std::pair<Key, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.first > rhs.first;
+    };
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)>;
+
+    SearchLabels labels[2] = {{{from, SearchLabel{ZERO_KEY, std::nullopt}}},
+                              {{to, SearchLabel{ZERO_KEY, std::nullopt}}}};
+    Queue queues[2] = {Queue(greater), Queue(greater)};
+    queues[0].push({ZERO_KEY, from});
+    queues[1].push({ZERO_KEY, to});
+    const std::vector<std::vector<EdgeId>>* search_edges[2] = {&upward_edges_, &downward_edges_};
+
+    std::optional<Key> best_key;
+    VertexId meeting_vertex = from;
+
+    // 0 - forward search from "from", 1 - backward search from "to"
+    auto is_active = [&](size_t direction) {
+        return !queues[direction].empty()
+               && (!best_key || queues[direction].top().first < *best_key);
+    };
+
+    size_t direction = 0;
+    while (is_active(0) || is_active(1)) {
+        if (!is_active(direction)) direction = 1 - direction;
+
+        const auto [key, vertex] = queues[direction].top();
+        queues[direction].pop();
+        if (labels[direction].at(vertex).key < key) continue;     // outdated queue item
+
+        if (auto it = labels[1 - direction].find(vertex); it != labels[1 - direction].end()) {
+            const Key candidate_key = key + it->second.key;
+            if (!best_key || candidate_key < *best_key) {
+                best_key = candidate_key;
+                meeting_vertex = vertex;
+            }
+        }
+
+        for (const EdgeId edge_id : (*search_edges[direction])[vertex]) {
+            const VertexId next = direction == 0 ? GetEdgeTo(edge_id) : GetEdgeFrom(edge_id);
+            const Key candidate_key = key + GetRouteKey(GetEdgeWeight(edge_id));
+            auto it = labels[direction].find(next);
+            if (it == labels[direction].end() || candidate_key < it->second.key) {
+                labels[direction][next] = SearchLabel{candidate_key, edge_id};
+                queues[direction].push({candidate_key, next});
+            }
+        }
+        direction = 1 - direction;
+    }
+
+    if (!best_key) {
+        return std::nullopt;
+    }
+
+    // hierarchy edges from "from" to meeting vertex and from meeting vertex to "to"
+    std::vector<EdgeId> path;
+    for (std::optional<EdgeId> edge_id = labels[0].at(meeting_vertex).prev_edge;
+         edge_id;
+         edge_id = labels[0].at(GetEdgeFrom(*edge_id)).prev_edge)
+    {
+        path.push_back(*edge_id);
+    }
+    std::reverse(path.begin(), path.end());
+    for (std::optional<EdgeId> edge_id = labels[1].at(meeting_vertex).prev_edge;
+         edge_id;
+         edge_id = labels[1].at(GetEdgeTo(*edge_id)).prev_edge)
+    {
+        path.push_back(*edge_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : path) {
+        UnpackEdge(edge_id, edges);
+    }
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+inline const ContractionHierarchyInternalState<Weight>
+ContractionHierarchy<Weight>::ExportInternalState() const {
+    return ContractionHierarchyInternalState<Weight>{vertex_ranks_, shortcuts_};
+}
+
+template <typename Weight>
+inline void ContractionHierarchy<Weight>::ExternalInitialization
+            (std::vector<size_t>&& vertex_ranks, std::vector<Shortcut<Weight>>&& shortcuts) {
+    std::swap(vertex_ranks_, vertex_ranks);
+    std::swap(shortcuts_, shortcuts);
+    BuildSearchGraph();
+}
+
+}  // namespace graph
@@ -0,0 +1,185 @@
+#pragma once
+
+/* On-demand router. Runs single-source Dijkstra when a query arrives
+ * and keeps the latest shortest-path trees in a size-bounded LRU cache.
+ * Needs no preprocessing and O(V) memory per cached tree instead of V x V matrix.
+ * Trees keep route keys only, route weight is summed along edges of the found route.
+ * Cached trees are immutable and shared with queries using them, only cache list is locked,
+ * so queries from concurrent threads compute trees in parallel.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class DijkstraRouter {
+public:
+    using Graph = CsrGraph<Weight>;
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    /* cache_size - max number of shortest-path trees kept in cache (0 - no caching) */
+    DijkstraRouter(const Graph& graph, size_t cache_size);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    /* Routes from one vertex to many, with single shortest-path tree */
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& to) const;
+
+private:
+    using Key = RouteKey<Weight>;
+
+    /* route from tree root to the vertex */
+    struct TreeLabel {
+        Key key;
+        EdgeId prev_edge;       /* min_plus::NO_EDGE for tree root */
+    };
+    /* index = vertex_id, nullopt if vertex is not reachable */
+    using ShortestPathTree = std::vector<std::optional<TreeLabel>>;
+    using TreePtr = std::shared_ptr<const ShortestPathTree>;
+    using CacheList = std::list<std::pair<VertexId, TreePtr>>;
+
+    ShortestPathTree ComputeShortestPathTree(VertexId from) const;
+    TreePtr GetShortestPathTree(VertexId from) const;
+    std::optional<RouteInfo> UnwindRoute(const ShortestPathTree& tree, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Key ZERO_KEY{};
+    const Graph& graph_;
+    size_t cache_size_;
+
+    mutable std::mutex cache_mutex_;                                        /* guards cache list and index */
+    mutable CacheList cache_;                                               /* most recently used first */
+    mutable std::unordered_map<VertexId, typename CacheList::iterator> cache_index_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t cache_size)
+    : graph_(graph)
+    , cache_size_(cache_size)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+typename DijkstraRouter<Weight>::ShortestPathTree
+DijkstraRouter<Weight>::ComputeShortestPathTree(VertexId from) const {
+    ShortestPathTree tree(graph_.GetVertexCount());
+    tree.at(from) = TreeLabel{ZERO_KEY, min_plus::NO_EDGE};
+
+    using QueueItem = std::pair<Key, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.first > rhs.first;
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)> queue(greater);
+    queue.push({ZERO_KEY, from});
+
+    while (!queue.empty()) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (tree[vertex]->key < key) continue;      // outdated queue item
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Key candidate_key = key + GetRouteKey(edge.weight);
+            auto& route = tree[edge.to];
+            if (!route || candidate_key < route->key) {
+                route = TreeLabel{candidate_key, edge_id};
+                queue.push({candidate_key, edge.to});
+            }
+        }
+    }
+    return tree;
+}
+
+/* Tree is computed without lock. Threads which miss the same origin concurrently compute it each,
+   the first one puts it to cache */
+template <typename Weight>
+typename DijkstraRouter<Weight>::TreePtr DijkstraRouter<Weight>::GetShortestPathTree(VertexId from) const {
+    if (cache_size_ == 0) {
+        return std::make_shared<const ShortestPathTree>(ComputeShortestPathTree(from));
+    }
+
+    {
+        std::lock_guard lock(cache_mutex_);
+        if (auto it = cache_index_.find(from); it != cache_index_.end()) {
+            cache_.splice(cache_.begin(), cache_, it->second);      // mark as most recently used
+            return cache_.front().second;
+        }
+    }
+
+    TreePtr tree = std::make_shared<const ShortestPathTree>(ComputeShortestPathTree(from));
+
+    std::lock_guard lock(cache_mutex_);
+    if (auto it = cache_index_.find(from); it != cache_index_.end()) {
+        cache_.splice(cache_.begin(), cache_, it->second);
+        return cache_.front().second;
+    }
+    if (cache_.size() >= cache_size_) {                             // evict least recently used
+        cache_index_.erase(cache_.back().first);
+        cache_.pop_back();
+    }
+    cache_.emplace_front(from, std::move(tree));
+    cache_index_[from] = cache_.begin();
+    return cache_.front().second;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    return UnwindRoute(*GetShortestPathTree(from), to);
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>>
+DijkstraRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& to) const {
+    const TreePtr tree = GetShortestPathTree(from);
+    std::vector<std::optional<RouteInfo>> result;
+    result.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        result.push_back(UnwindRoute(*tree, vertex_to));
+    }
+    return result;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::UnwindRoute(const ShortestPathTree& tree, VertexId to) const {
+    const auto& label = tree.at(to);
+    if (!label) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = label->prev_edge;
+         edge_id != min_plus::NO_EDGE;
+         edge_id = tree[graph_.GetEdge(edge_id).from]->prev_edge)
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,88 @@
+#include "distance_table.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace domain {
+
+using namespace std;
+
+uint64_t DistanceTable::MakeKey(size_t from, size_t to) {
+    if (from >= numeric_limits<uint32_t>::max() || to >= numeric_limits<uint32_t>::max()) {
+        throw length_error("Stop id doesn't fit distance table key");
+    }
+    return (static_cast<uint64_t>(from) << 32) | static_cast<uint64_t>(to);
+}
+
+/* 64-bit finalizer of MurmurHash3, spreads both ids over all bits */
+size_t DistanceTable::Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+size_t DistanceTable::FindSlot(uint64_t key) const {
+    const size_t mask = slots_.size() - 1;
+    size_t index = Hash(key) & mask;
+    while (slots_[index].key != key && slots_[index].key != EMPTY_KEY) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void DistanceTable::Grow() {
+    vector<Slot> old_slots(max<size_t>(16, slots_.size() * 2));
+    old_slots.swap(slots_);
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            slots_[FindSlot(slot.key)] = slot;
+        }
+    }
+}
+
+void DistanceTable::Put(uint64_t key, int distance, bool is_set) {
+    if (2 * (size_ + 1) > slots_.size()) Grow();
+    Slot& slot = slots_[FindSlot(key)];
+    if (slot.key == EMPTY_KEY) {
+        slot.key = key;
+        ++size_;
+    }
+    slot.distance = distance;
+    slot.is_set = is_set;
+}
+
+void DistanceTable::Set(size_t from, size_t to, int distance) {
+    Put(MakeKey(from, to), distance, true);
+
+    // reverse direction takes the distance unless it has its own
+    const uint64_t reverse_key = MakeKey(to, from);
+    if (!slots_.empty()) {
+        const Slot& reverse_slot = slots_[FindSlot(reverse_key)];
+        if (reverse_slot.key == reverse_key && reverse_slot.is_set) return;
+    }
+    Put(reverse_key, distance, false);
+}
+
+int DistanceTable::Get(size_t from, size_t to) const {
+    if (slots_.empty()) return 0;
+    const uint64_t key = MakeKey(from, to);
+    const Slot& slot = slots_[FindSlot(key)];
+    return slot.key == key ? slot.distance : 0;
+}
+
+vector<DistanceTable::Distance> DistanceTable::GetSetDistances() const {
+    vector<Distance> result;
+    for (const Slot& slot : slots_) {
+        if (slot.key != EMPTY_KEY && slot.is_set) {
+            result.push_back(Distance{static_cast<uint32_t>(slot.key >> 32),
+                                      static_cast<uint32_t>(slot.key),
+                                      slot.distance});
+        }
+    }
+    return result;
+}
+
+} // namespace domain
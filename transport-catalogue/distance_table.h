@@ -0,0 +1,52 @@
+#pragma once
+
+/* Road distances between stops. Open addressing hash table with linear probing, key is
+ * the pair of 32-bit stop ids packed to 64 bits. Distance set for one direction is stored
+ * for the reverse direction too, unless the reverse one is set itself, so lookup of
+ * a distance in either direction is a single probe sequence.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace domain {
+
+class DistanceTable {
+public:
+    /* distance set by SetDistance */
+    struct Distance {
+        uint32_t from;
+        uint32_t to;
+        int distance;
+    };
+
+    void Set(size_t from, size_t to, int distance);
+
+    /* Distance from stop to stop, reverse distance if it is not set, 0 if neither is set */
+    int Get(size_t from, size_t to) const;
+
+    /* Distances set by Set, reverse ones are not included */
+    std::vector<Distance> GetSetDistances() const;
+
+private:
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        int distance = 0;
+        bool is_set = false;        /* false - distance is taken from the reverse direction */
+    };
+
+    static uint64_t MakeKey(size_t from, size_t to);
+    static size_t Hash(uint64_t key);
+    /* slot with the key or empty slot where it should be inserted */
+    size_t FindSlot(uint64_t key) const;
+    void Grow();
+    void Put(uint64_t key, int distance, bool is_set);
+
+    std::vector<Slot> slots_;       /* size is power of 2, at most half is occupied */
+    size_t size_ = 0;
+};
+
+} // namespace domain
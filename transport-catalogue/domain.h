@@ -1,18 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
-#include <unordered_set>
 
 #include "geo.h"
+#include "ranges.h"
 
 namespace domain {
 
 /* bus stop. Contains: stop name, stop coordinates */
 struct Stop {
     size_t id;
-    std::string name;
+    std::string_view name;      /* interned in names pool of catalogue */
     geo::Coordinates coordinates;
 };
 
@@ -26,7 +27,7 @@ enum class BusType {
 /* bus route. Contains: bus name, all bus stops (aka bus route) */
 struct Bus {
     size_t id;
-    std::string name;
+    std::string_view name;      /* interned in names pool of catalogue */
     BusType type = BusType::UNKNOWN;
     std::vector<const Stop*> stops;
 };
@@ -34,7 +35,7 @@ struct Bus {
 /* bus info: name, stops count, unique stops count, geo route length, route length, curvuature.
    returned by GetBusInfo */
 struct BusInfo {
-    std::string name;
+    std::string_view name;      /* interned in names pool of catalogue */
     int stops_count = 0;
     int unique_stops_count = 0;
     double geo_route_length = 0;
@@ -42,18 +43,22 @@ struct BusInfo {
     double curvature = 1.0;
 };
 
-/* stop info: all buses names passes the stop.
-   returned by GetStopInfo */
-using StopInfo = std::unordered_set<std::string_view>;
-
-/* hasher for unordered_map<pair<const Stop*, const Stop*> */
-struct StopHasher {
-    std::size_t operator() (const std::pair<const Stop*, const Stop*> ptr_stop) const {
-        return hasher_(static_cast<const void*>(ptr_stop.first)) * 37
-             + hasher_(static_cast<const void*>(ptr_stop.second));
-    }
-private:
-    const std::hash<const void*> hasher_{};
+/* stop info: names of all buses passing the stop, unique and sorted.
+   view into stop-to-buses index of catalogue, returned by GetStopInfo */
+using StopInfo = ranges::Range<const std::string_view*>;
+
+/* kind of named object */
+enum class NameKind : uint8_t {
+    STOP,
+    BUS
+};
+
+/* name found by name search: name, kind, edit distance from the query to the closest prefix of name.
+   returned by SuggestNames */
+struct NameSuggestion {
+    std::string_view name;      /* interned in names pool of catalogue */
+    NameKind kind = NameKind::STOP;
+    size_t distance = 0;
 };
 
 } // namespace domain
\ No newline at end of file
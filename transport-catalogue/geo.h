@@ -2,6 +2,8 @@
 
 namespace geo {
 
+inline constexpr double EARTH_RADIUS = 6371000;     // meters
+
 struct Coordinates {
     double lat; // Широта
     double lng; // Долгота
@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <type_traits>
 #include <vector>
 
 namespace graph {
@@ -17,16 +18,30 @@ struct Edge {
     Weight weight;
 };
 
+/* Weight properties used by routers. Specialize with HAS_SCALAR_KEY = true and
+       static double GetKey(const Weight& weight);
+       static void SetKey(Weight& weight, double key);
+   if weights are ordered by a single double key; it enables vectorized routes precomputation */
 template <typename Weight>
-class DirectedWeightedGraph;
+struct WeightTraits {
+    static constexpr bool HAS_SCALAR_KEY = false;
+};
 
+/* Key + payload weight policy: searches relax and queue route keys only, full route weight is summed
+   along route edges when route is unpacked. Key is the scalar key if weight has it, weight itself otherwise */
 template <typename Weight>
-struct GraphInternalState {
-    using IncidenceList = typename DirectedWeightedGraph<Weight>::IncidenceList;
-    const typename DirectedWeightedGraph<Weight>::std::vector<Edge<Weight>>& edges;
-    const typename DirectedWeightedGraph<Weight>::std::vector<IncidenceList>& incidence_list;
-};
+using RouteKey = std::conditional_t<WeightTraits<Weight>::HAS_SCALAR_KEY, double, Weight>;
+
+template <typename Weight>
+RouteKey<Weight> GetRouteKey(const Weight& weight) {
+    if constexpr (WeightTraits<Weight>::HAS_SCALAR_KEY) {
+        return WeightTraits<Weight>::GetKey(weight);
+    } else {
+        return weight;
+    }
+}
 
+/* Mutable graph, used to build the graph edge by edge */
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
@@ -43,9 +58,6 @@ public:
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
-    const GraphInternalState<Weight> ExportInternalState() const;
-    void ExternalInitialization(std::vector<Edge<Weight>>&& edges, 
-                                std::vector<IncidenceList>&& incidence_list);
 private:
     std::vector<Edge<Weight>> edges_;               // index = edge_id, data = Edge<weight>
     std::vector<IncidenceList> incidence_lists_;    // index = from_vertex_id, data = vector<EdgeId>
@@ -87,17 +99,99 @@ DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
 }
 
 template <typename Weight>
-inline const GraphInternalState<Weight> 
-DirectedWeightedGraph<Weight>::ExportInternalState() const{
-    return GraphInternalState<Weight>{edges_, incidence_lists_};
+class CsrGraph;
+
+template <typename Weight>
+struct CsrGraphInternalState {
+    const std::vector<Edge<Weight>>& edges;
+    const std::vector<EdgeId>& offsets;
+};
+
+/* Frozen graph in compressed sparse row layout. Edges are sorted by source vertex,
+   edges started from vertex v are [offsets[v], offsets[v + 1]).
+   Edge ids differ from ids of the DirectedWeightedGraph it was built from. */
+template <typename Weight>
+class CsrGraph {
+private:
+    using IncidentEdgesRange = ranges::Range<ranges::IndexIterator<EdgeId>>;
+
+public:
+    explicit CsrGraph(size_t vertex_count = 0);
+    explicit CsrGraph(const DirectedWeightedGraph<Weight>& graph);
+    /* edge_ids - filled with CSR edge id for every edge id of source graph */
+    CsrGraph(const DirectedWeightedGraph<Weight>& graph, std::vector<EdgeId>& edge_ids);
+
+    size_t GetVertexCount() const;
+    size_t GetEdgeCount() const;
+    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+
+    const CsrGraphInternalState<Weight> ExportInternalState() const;
+    void ExternalInitialization(std::vector<Edge<Weight>>&& edges, std::vector<EdgeId>&& offsets);
+
+private:
+    std::vector<Edge<Weight>> edges_;   // index = edge_id, sorted by edge.from
+    std::vector<EdgeId> offsets_;       // index = from_vertex_id, data = first edge of vertex; size = vertex count + 1
+};
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(size_t vertex_count)
+    : offsets_(vertex_count + 1, 0) {
+}
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph)
+    : offsets_(graph.GetVertexCount() + 1, 0) {
+    std::vector<EdgeId> edge_ids;
+    *this = CsrGraph(graph, edge_ids);
+}
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph, std::vector<EdgeId>& edge_ids)
+    : offsets_(graph.GetVertexCount() + 1, 0) {
+    const size_t vertex_count = graph.GetVertexCount();
+    edges_.reserve(graph.GetEdgeCount());
+    edge_ids.assign(graph.GetEdgeCount(), 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            edge_ids[edge_id] = edges_.size();
+            edges_.push_back(graph.GetEdge(edge_id));
+        }
+        offsets_[vertex + 1] = edges_.size();
+    }
+}
+
+template <typename Weight>
+size_t CsrGraph<Weight>::GetVertexCount() const {
+    return offsets_.size() - 1;
+}
+
+template <typename Weight>
+size_t CsrGraph<Weight>::GetEdgeCount() const {
+    return edges_.size();
+}
+
+template <typename Weight>
+const Edge<Weight>& CsrGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    return edges_[edge_id];
+}
+
+template <typename Weight>
+typename CsrGraph<Weight>::IncidentEdgesRange
+CsrGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    return ranges::AsIndexRange(offsets_[vertex], offsets_[vertex + 1]);
+}
+
+template <typename Weight>
+inline const CsrGraphInternalState<Weight> CsrGraph<Weight>::ExportInternalState() const {
+    return CsrGraphInternalState<Weight>{edges_, offsets_};
 }
 
 template <typename Weight>
-inline void DirectedWeightedGraph<Weight>::ExternalInitialization
-    (std::vector<Edge<Weight>> &&edges, std::vector<IncidenceList> &&incidence_list) {
-    
+inline void CsrGraph<Weight>::ExternalInitialization
+            (std::vector<Edge<Weight>>&& edges, std::vector<EdgeId>&& offsets) {
     std::swap(edges_, edges);
-    std::swap(incidence_lists_, incidence_list);
+    std::swap(offsets_, offsets);
 }
 
 } // namespace graph
\ No newline at end of file
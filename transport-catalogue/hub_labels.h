@@ -0,0 +1,353 @@
+#pragma once
+
+/* Hub labeling (2-hop cover) router.
+ * Every vertex has forward label - hubs reachable from it with route keys, and backward label -
+ * hubs it is reachable from. Labels are built by pruned Dijkstra searches from vertexes in order
+ * of importance: a vertex already covered by more important hubs is not labeled and not expanded.
+ * Query merges forward label of source and backward label of destination, both sorted by hub rank.
+ * Every label entry keeps the first (forward) or the last (backward) edge of its route, the next
+ * vertex of the route has the same hub in its label, so routes are unpacked hop by hop.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/* Labels of all vertexes in CSR layout, entries of vertex are sorted by hub rank */
+struct HubLabelsData {
+    std::vector<size_t> offsets;        /* index = vertex id, entries [offsets[v], offsets[v + 1]) */
+    std::vector<uint32_t> hubs;         /* hub rank */
+    std::vector<float> keys;            /* route key between vertex and hub */
+    std::vector<uint32_t> edges;        /* first or last route edge, NO_LABEL_EDGE for hub itself */
+};
+
+template <typename Weight>
+class HubLabels;
+
+template <typename Weight>
+struct HubLabelsInternalState {
+    const std::vector<VertexId>& hub_vertexes;      /* index = hub rank */
+    const HubLabelsData& forward_labels;
+    const HubLabelsData& backward_labels;
+};
+
+template <typename Weight>
+class HubLabels {
+    static_assert(WeightTraits<Weight>::HAS_SCALAR_KEY, "Hub labels need weights with scalar key");
+
+public:
+    using Graph = CsrGraph<Weight>;
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    static constexpr uint32_t NO_LABEL_EDGE = std::numeric_limits<uint32_t>::max();
+
+    explicit HubLabels(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    const HubLabelsInternalState<Weight> ExportInternalState() const;
+    void ExternalInitialization(std::vector<VertexId>&& hub_vertexes,
+                                HubLabelsData&& forward_labels,
+                                HubLabelsData&& backward_labels);
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+    struct LabelEntry {
+        uint32_t hub;
+        double key;
+        uint32_t edge;
+    };
+    using Labels = std::vector<std::vector<LabelEntry>>;
+
+    /* preprocessing state: reversed edges in CSR layout, labels being built
+       and per-vertex search labels reused between searches */
+    struct BuildState {
+        std::vector<size_t> reversed_offsets;
+        std::vector<EdgeId> reversed_edges;
+        Labels forward_labels;
+        Labels backward_labels;
+        std::vector<double> hub_keys;       /* index = hub rank, key from label of searching hub */
+        std::vector<double> keys;
+        std::vector<uint32_t> edges;
+        std::vector<VertexId> reached_vertexes;
+    };
+
+    /* vertexes ordered by (out degree + 1) * (in degree + 1), descending */
+    void OrderVertexes();
+    /* Pruned Dijkstra from hub rank vertex, backward - over reversed edges, fills labels of reached vertexes */
+    void PrunedSearch(uint32_t rank, bool backward, BuildState& state) const;
+    static HubLabelsData Flatten(const Labels& labels);
+    /* entry index of hub in vertex label, labels hold hub for every vertex of unpacked route */
+    static size_t FindEntry(const HubLabelsData& labels, VertexId vertex, uint32_t hub);
+    void CheckData(const HubLabelsData& labels) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    std::vector<VertexId> hub_vertexes_;
+    HubLabelsData forward_labels_;
+    HubLabelsData backward_labels_;
+};
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    if (edge_count >= NO_LABEL_EDGE) {
+        throw std::length_error("Too many edges for hub labels");
+    }
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    OrderVertexes();
+
+    BuildState state{std::vector<size_t>(vertex_count + 1, 0),
+                     std::vector<EdgeId>(edge_count),
+                     Labels(vertex_count),
+                     Labels(vertex_count),
+                     std::vector<double>(vertex_count, INF),
+                     std::vector<double>(vertex_count, INF),
+                     std::vector<uint32_t>(vertex_count, NO_LABEL_EDGE),
+                     {}};
+
+    // reversed edges in CSR layout
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        ++state.reversed_offsets[graph.GetEdge(edge_id).to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        state.reversed_offsets[vertex + 1] += state.reversed_offsets[vertex];
+    }
+    std::vector<size_t> fill(state.reversed_offsets.begin(), state.reversed_offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        state.reversed_edges[fill[graph.GetEdge(edge_id).to]++] = edge_id;
+    }
+
+    // hubs are processed in rank order, so label entries come sorted by hub rank
+    for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+        PrunedSearch(rank, false, state);
+        PrunedSearch(rank, true, state);
+    }
+    forward_labels_ = Flatten(state.forward_labels);
+    backward_labels_ = Flatten(state.backward_labels);
+}
+
+template <typename Weight>
+void HubLabels<Weight>::OrderVertexes() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<size_t> out_degrees(vertex_count, 0);
+    std::vector<size_t> in_degrees(vertex_count, 0);
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        ++out_degrees[graph_.GetEdge(edge_id).from];
+        ++in_degrees[graph_.GetEdge(edge_id).to];
+    }
+    std::vector<size_t> importance(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        importance[vertex] = (out_degrees[vertex] + 1) * (in_degrees[vertex] + 1);
+    }
+
+    hub_vertexes_.resize(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        hub_vertexes_[vertex] = vertex;
+    }
+    std::stable_sort(hub_vertexes_.begin(), hub_vertexes_.end(), [&importance](VertexId lhs, VertexId rhs) {
+        return importance[lhs] > importance[rhs];
+    });
+}
+
+/* Forward search from hub labels backward labels of reached vertexes and vice versa.
+   Vertex is pruned if existing labels already give route not longer than the search one */
+template <typename Weight>
+void HubLabels<Weight>::PrunedSearch(uint32_t rank, bool backward, BuildState& state) const {
+    const VertexId hub = hub_vertexes_[rank];
+    /* hub label gives keys for pruning test, search fills labels of the other side */
+    const auto& hub_label = backward ? state.backward_labels[hub] : state.forward_labels[hub];
+    Labels& labeled = backward ? state.forward_labels : state.backward_labels;
+    auto& hub_keys = state.hub_keys;
+    auto& keys = state.keys;
+    auto& edges = state.edges;
+
+    for (const LabelEntry& entry : hub_label) {
+        hub_keys[entry.hub] = entry.key;
+    }
+
+    using QueueItem = std::pair<double, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    keys[hub] = 0;
+    edges[hub] = NO_LABEL_EDGE;
+    state.reached_vertexes.push_back(hub);
+    queue.push({0, hub});
+
+    auto relax = [&](double key, EdgeId edge_id, VertexId next) {
+        const double candidate = key + WeightTraits<Weight>::GetKey(graph_.GetEdge(edge_id).weight);
+        if (candidate < keys[next]) {
+            if (keys[next] == INF) state.reached_vertexes.push_back(next);
+            keys[next] = candidate;
+            edges[next] = static_cast<uint32_t>(edge_id);
+            queue.push({candidate, next});
+        }
+    };
+
+    while (!queue.empty()) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (keys[vertex] < key) continue;   // outdated queue item
+
+        bool is_covered = false;
+        for (const LabelEntry& entry : labeled[vertex]) {
+            if (hub_keys[entry.hub] + entry.key <= key) {
+                is_covered = true;
+                break;
+            }
+        }
+        if (is_covered) continue;
+        labeled[vertex].push_back(LabelEntry{rank, key, edges[vertex]});
+
+        if (backward) {
+            for (size_t i = state.reversed_offsets[vertex]; i < state.reversed_offsets[vertex + 1]; ++i) {
+                relax(key, state.reversed_edges[i], graph_.GetEdge(state.reversed_edges[i]).from);
+            }
+        } else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(key, edge_id, graph_.GetEdge(edge_id).to);
+            }
+        }
+    }
+
+    for (const LabelEntry& entry : hub_label) {
+        hub_keys[entry.hub] = INF;
+    }
+    for (const VertexId vertex : state.reached_vertexes) {
+        keys[vertex] = INF;
+    }
+    state.reached_vertexes.clear();
+}
+
+template <typename Weight>
+HubLabelsData HubLabels<Weight>::Flatten(const Labels& labels) {
+    HubLabelsData result;
+    result.offsets.reserve(labels.size() + 1);
+    result.offsets.push_back(0);
+    for (const auto& label : labels) {
+        for (const LabelEntry& entry : label) {
+            result.hubs.push_back(entry.hub);
+            result.keys.push_back(static_cast<float>(entry.key));
+            result.edges.push_back(entry.edge);
+        }
+        result.offsets.push_back(result.hubs.size());
+    }
+    return result;
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::FindEntry(const HubLabelsData& labels, VertexId vertex, uint32_t hub) {
+    const auto begin = labels.hubs.begin() + labels.offsets[vertex];
+    const auto end = labels.hubs.begin() + labels.offsets[vertex + 1];
+    const auto it = std::lower_bound(begin, end, hub);
+    if (it == end || *it != hub) {
+        throw std::logic_error("Hub labels are inconsistent");
+    }
+    return it - labels.hubs.begin();
+}
+
+template <typename Weight>
+std::optional<typename HubLabels<Weight>::RouteInfo>
+HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = hub_vertexes_.size();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of graph");
+    }
+
+    // merge labels sorted by hub rank
+    double best_key = INF;
+    uint32_t best_hub = 0;
+    size_t i = forward_labels_.offsets[from];
+    size_t j = backward_labels_.offsets[to];
+    const size_t i_end = forward_labels_.offsets[from + 1];
+    const size_t j_end = backward_labels_.offsets[to + 1];
+    while (i < i_end && j < j_end) {
+        const uint32_t forward_hub = forward_labels_.hubs[i];
+        const uint32_t backward_hub = backward_labels_.hubs[j];
+        if (forward_hub < backward_hub) {
+            ++i;
+        } else if (backward_hub < forward_hub) {
+            ++j;
+        } else {
+            const double key = static_cast<double>(forward_labels_.keys[i]) + backward_labels_.keys[j];
+            if (key < best_key) {
+                best_key = key;
+                best_hub = forward_hub;
+            }
+            ++i;
+            ++j;
+        }
+    }
+    if (best_key == INF) return std::nullopt;
+
+    // unpack route from source to hub by first edges and from destination to hub by last edges
+    const VertexId hub = hub_vertexes_[best_hub];
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = from; vertex != hub; ) {
+        const EdgeId edge_id = forward_labels_.edges[FindEntry(forward_labels_, vertex, best_hub)];
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).to;
+    }
+    std::vector<EdgeId> tail_edges;
+    for (VertexId vertex = to; vertex != hub; ) {
+        const EdgeId edge_id = backward_labels_.edges[FindEntry(backward_labels_, vertex, best_hub)];
+        tail_edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    edges.insert(edges.end(), tail_edges.rbegin(), tail_edges.rend());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+inline const HubLabelsInternalState<Weight> HubLabels<Weight>::ExportInternalState() const {
+    return HubLabelsInternalState<Weight>{hub_vertexes_, forward_labels_, backward_labels_};
+}
+
+template <typename Weight>
+void HubLabels<Weight>::CheckData(const HubLabelsData& labels) const {
+    const size_t size = labels.hubs.size();
+    if (labels.offsets.size() != graph_.GetVertexCount() + 1 || labels.offsets.front() != 0
+        || labels.offsets.back() != size || labels.keys.size() != size || labels.edges.size() != size) {
+        throw std::invalid_argument("Hub labels size doesn't match graph");
+    }
+}
+
+template <typename Weight>
+inline void HubLabels<Weight>::ExternalInitialization(std::vector<VertexId>&& hub_vertexes,
+                                                      HubLabelsData&& forward_labels,
+                                                      HubLabelsData&& backward_labels) {
+    if (hub_vertexes.size() != graph_.GetVertexCount()) {
+        throw std::invalid_argument("Hub vertexes size doesn't match graph");
+    }
+    CheckData(forward_labels);
+    CheckData(backward_labels);
+    hub_vertexes_ = std::move(hub_vertexes);
+    forward_labels_ = std::move(forward_labels);
+    backward_labels_ = std::move(backward_labels);
+}
+
+}  // namespace graph
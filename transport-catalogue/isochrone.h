@@ -0,0 +1,143 @@
+#pragma once
+
+/* One-to-all search bounded by route key limit (isochrone). Vertexes are taken from bucket queue:
+ * bucket i keeps vertexes with key in [i * width, (i + 1) * width). Width is not less than
+ * the least positive edge key, so relaxation moves vertex to a later bucket and most vertexes
+ * are scanned once. Zero key edges put vertexes to the current bucket, improved vertexes are
+ * scanned again. Vertexes with key over the limit are never queued, so search stops at the limit.
+ * Labels and buckets are kept per thread, so searches from concurrent threads need no locks.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class IsochroneSearch {
+    static_assert(WeightTraits<Weight>::HAS_SCALAR_KEY, "Isochrone search needs weights with scalar key");
+
+public:
+    using Graph = CsrGraph<Weight>;
+    /* vertex, route key from source */
+    using ReachedVertex = std::pair<VertexId, double>;
+
+    explicit IsochroneSearch(const Graph& graph);
+
+    /* Vertexes with route key from source not greater than limit, in order of key */
+    std::vector<ReachedVertex> FindReachable(VertexId from, double limit) const;
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+    static constexpr size_t MAX_BUCKETS = 1 << 16;
+
+    /* flat per-vertex search labels and buckets, reused between searches of the thread */
+    struct SearchLabels {
+        std::vector<double> keys;
+        std::vector<VertexId> reached_vertexes;     /* vertexes with finite key, for reset */
+        std::vector<std::vector<VertexId>> buckets;
+    };
+
+    /* Labels of calling thread with previous search leftovers reset, sized to the graph */
+    SearchLabels& GetSearchLabels() const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    double min_edge_key_ = INF;     /* least positive edge key */
+};
+
+template <typename Weight>
+IsochroneSearch<Weight>::IsochroneSearch(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& weight = graph.GetEdge(edge_id).weight;
+        if (weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const double key = WeightTraits<Weight>::GetKey(weight);
+        if (key > 0) min_edge_key_ = std::min(min_edge_key_, key);
+    }
+}
+
+/* Completed search leaves all keys infinite and buckets empty, so only search interrupted
+   with exception leaves something to reset */
+template <typename Weight>
+typename IsochroneSearch<Weight>::SearchLabels& IsochroneSearch<Weight>::GetSearchLabels() const {
+    thread_local SearchLabels labels;
+    if (!labels.reached_vertexes.empty()) {
+        for (const VertexId vertex : labels.reached_vertexes) {
+            labels.keys[vertex] = INF;
+        }
+        labels.reached_vertexes.clear();
+        for (auto& bucket : labels.buckets) {
+            bucket.clear();
+        }
+    }
+    if (labels.keys.size() < graph_.GetVertexCount()) {
+        labels.keys.resize(graph_.GetVertexCount(), INF);
+    }
+    return labels;
+}
+
+template <typename Weight>
+std::vector<typename IsochroneSearch<Weight>::ReachedVertex>
+IsochroneSearch<Weight>::FindReachable(VertexId from, double limit) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of graph");
+    }
+    if (!(limit >= 0)) return {};
+    SearchLabels& labels = GetSearchLabels();
+    std::vector<double>& keys = labels.keys;
+    std::vector<std::vector<VertexId>>& buckets = labels.buckets;
+
+    // wide buckets for small edges and large limit keep bucket array bounded
+    const double width = std::max(min_edge_key_, limit / MAX_BUCKETS);
+    const size_t bucket_count = static_cast<size_t>(limit / width) + 1;
+    if (buckets.size() < bucket_count) buckets.resize(bucket_count);
+
+    keys[from] = 0;
+    labels.reached_vertexes.push_back(from);
+    buckets[0].push_back(from);
+
+    for (size_t i = 0; i < bucket_count; ++i) {
+        auto& bucket = buckets[i];
+        while (!bucket.empty()) {
+            const VertexId vertex = bucket.back();
+            bucket.pop_back();
+            const double key = keys[vertex];
+            if (static_cast<size_t>(key / width) != i) continue;   // outdated, moved to earlier bucket
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const double candidate = key + WeightTraits<Weight>::GetKey(edge.weight);
+                if (candidate <= limit && candidate < keys[edge.to]) {
+                    if (keys[edge.to] == INF) labels.reached_vertexes.push_back(edge.to);
+                    keys[edge.to] = candidate;
+                    buckets[static_cast<size_t>(candidate / width)].push_back(edge.to);
+                }
+            }
+        }
+    }
+
+    std::vector<ReachedVertex> result;
+    result.reserve(labels.reached_vertexes.size());
+    for (const VertexId vertex : labels.reached_vertexes) {
+        result.emplace_back(vertex, keys[vertex]);
+        keys[vertex] = INF;
+    }
+    labels.reached_vertexes.clear();
+    std::sort(result.begin(), result.end(), [](const ReachedVertex& lhs, const ReachedVertex& rhs) {
+        return lhs.second < rhs.second;
+    });
+    return result;
+}
+
+}  // namespace graph
@@ -1,5 +1,7 @@
 #include "json_reader.h"
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 #include <string>
 
@@ -108,6 +110,69 @@ JSONReader::ParseRouterSettings() const {
     transport_router_settings.bus_velocity = settings.at("bus_velocity").AsDouble();
     // "bus_wait_time": 6
     transport_router_settings.bus_wait_time = settings.at("bus_wait_time").AsInt();
+    // "router_type": "all_pairs" | "dijkstra" | "contraction_hierarchy" | "raptor" | "a_star" | "hub_labels" | "lazy" (optional)
+    if (settings.count("router_type") != 0) {
+        const string& router_type = settings.at("router_type").AsString();
+        if (router_type == "all_pairs"s) {
+            transport_router_settings.router_type = transport_router::RouterType::ALL_PAIRS;
+        } else if (router_type == "dijkstra"s) {
+            transport_router_settings.router_type = transport_router::RouterType::DIJKSTRA;
+        } else if (router_type == "contraction_hierarchy"s) {
+            transport_router_settings.router_type = transport_router::RouterType::CONTRACTION_HIERARCHY;
+        } else if (router_type == "raptor"s) {
+            transport_router_settings.router_type = transport_router::RouterType::RAPTOR;
+        } else if (router_type == "a_star"s) {
+            transport_router_settings.router_type = transport_router::RouterType::A_STAR;
+        } else if (router_type == "hub_labels"s) {
+            transport_router_settings.router_type = transport_router::RouterType::HUB_LABELS;
+        } else if (router_type == "lazy"s) {
+            transport_router_settings.router_type = transport_router::RouterType::LAZY;
+        } else {
+            throw JSONReaderError("\"routing_settings\" unknown router_type."s);
+        }
+    }
+    // "route_cache_size": 128 (optional)
+    if (settings.count("route_cache_size") != 0) {
+        transport_router_settings.route_cache_size = ParseSizeSetting(settings, "route_cache_size"s);
+    }
+    // "thread_count": 8 (optional)
+    if (settings.count("thread_count") != 0) {
+        transport_router_settings.thread_count = ParseSizeSetting(settings, "thread_count"s);
+    }
+    // "landmark_count": 16 (optional)
+    if (settings.count("landmark_count") != 0) {
+        transport_router_settings.landmark_count = ParseSizeSetting(settings, "landmark_count"s);
+    }
+    // "route_memory_limit": 64 (optional)
+    if (settings.count("route_memory_limit") != 0) {
+        transport_router_settings.route_memory_limit = ParseSizeSetting(settings, "route_memory_limit"s);
+    }
+    // "max_transfers": 2 (optional)
+    if (settings.count("max_transfers") != 0) {
+        transport_router_settings.max_transfers = ParseSizeSetting(settings, "max_transfers"s);
+    }
+    // "routes_table_algorithm": "floyd_warshall" | "dijkstra" (optional)
+    if (settings.count("routes_table_algorithm") != 0) {
+        const string& algorithm = settings.at("routes_table_algorithm").AsString();
+        if (algorithm == "floyd_warshall"s) {
+            transport_router_settings.routes_table_algorithm = graph::RoutesTableAlgorithm::FLOYD_WARSHALL;
+        } else if (algorithm == "dijkstra"s) {
+            transport_router_settings.routes_table_algorithm = graph::RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA;
+        } else {
+            throw JSONReaderError("\"routing_settings\" unknown routes_table_algorithm."s);
+        }
+    }
+    // "graph_model": "direct" | "transfer" (optional)
+    if (settings.count("graph_model") != 0) {
+        const string& graph_model = settings.at("graph_model").AsString();
+        if (graph_model == "direct"s) {
+            transport_router_settings.graph_model = transport_router::GraphModel::DIRECT;
+        } else if (graph_model == "transfer"s) {
+            transport_router_settings.graph_model = transport_router::GraphModel::TRANSFER;
+        } else {
+            throw JSONReaderError("\"routing_settings\" unknown graph_model."s);
+        }
+    }
 
     return transport_router_settings;
 }
@@ -128,10 +193,23 @@ void JSONReader::MakeBase(RequestHandler& request_handler) {
     LoadBusesAndDistances(base_requests, request_handler);   // 2nd pass
 }
 
+/* Parse Update requests, apply them to transport catalogue and patch transport router */
+void JSONReader::UpdateBase(RequestHandler& request_handler, transport_router::TransportRouter& transport_router) {
+    /* Process with requests: { "update_requests": [ ... ] }
+    */
+    const json::Node& root = json_document_.GetRoot();
+    if (root.AsDict().count("update_requests") == 0 
+        || !root.AsDict().at("update_requests").IsArray()) {
+
+        throw JSONReaderError("\"update_requests\" section format error."s);
+    }
+
+    const json::Array& update_requests = root.AsDict().at("update_requests").AsArray();
+    transport_router.UpdateBuses(ApplyUpdates(update_requests, request_handler));
+}
+
 /* Parse Stat requests, ask transport catalogue and output result to JSON */
-void JSONReader::ProcessStatRequests(renderer::MapRenderer &renderer, 
-                                 transport_router::TransportRouter &transport_router, 
-                                 RequestHandler &request_handler) {
+void JSONReader::ProcessStatRequests(renderer::MapRenderer &renderer, const SnapshotHolder& snapshots) {
     /* Process with requests: { "stat_requests": [ ... ] }
     */
     const json::Node& root = json_document_.GetRoot();
@@ -142,7 +220,7 @@ void JSONReader::ProcessStatRequests(renderer::MapRenderer &renderer,
     }
 
     const json::Array& stat_requests = root.AsDict().at("stat_requests").AsArray();
-    json::Document result{ProcessStatRequest(stat_requests, renderer, transport_router, request_handler)};
+    json::Document result{ProcessStatRequest(stat_requests, renderer, snapshots)};
     json::Print(result, output_);
 }
 
@@ -227,6 +305,82 @@ void LoadBusesAndDistances(const json::Array& base_requests, RequestHandler& req
     }
 }
 
+/* Returns ids of added, removed and changed buses */
+unordered_set<size_t> ApplyUpdates(const json::Array& update_requests, RequestHandler& request_handler) {
+    /* Bus request (add or replace bus) has the same format as at "base_requests".
+       Stop request changes road distances of existing stop:
+            { "type": "Stop", "name": "Электросети", "road_distances": { "Улица Докучаева": 3100 } }
+       RemoveBus request: { "type": "RemoveBus", "name": "14" }
+    */
+    unordered_set<size_t> bus_ids;
+    for (const auto& request : update_requests) {
+        if (!request.IsDict() || request.AsDict().count("type") == 0 || request.AsDict().count("name") == 0) {
+            throw JSONReaderError("\"update_requests\" section format error."s);
+        }
+        const auto& content = request.AsDict();
+        const string& type = content.at("type").AsString();
+        const string& name = content.at("name").AsString();
+
+        if (type == "Bus"s || type == "RemoveBus"s) {
+            if (const Bus* bus = request_handler.FindBus(name)) {
+                bus_ids.insert(bus->id);
+                request_handler.RemoveBus(name);
+            } else if (type == "RemoveBus"s) {
+                throw JSONReaderError("Unknown bus at \"update_requests\" section."s);
+            }
+            if (type == "RemoveBus"s) continue;
+
+            if (content.count("stops") == 0 || content.count("is_roundtrip") == 0) {
+                throw JSONReaderError("Bus request at \"update_requests\" section format error."s);
+            }
+            vector<string> stops;
+            for (const auto& stop_name : content.at("stops").AsArray()) {
+                if (!request_handler.FindStop(stop_name.AsString())) {
+                    throw JSONReaderError("Unknown stop at \"update_requests\" section."s);
+                }
+                stops.push_back(stop_name.AsString());
+            }
+            auto roundtrip = (content.at("is_roundtrip").AsBool()) ? BusType::CIRCULAR : BusType::LINEAR;
+            request_handler.AddBus(name, roundtrip, stops);
+            bus_ids.insert(request_handler.FindBus(name)->id);
+
+        } else if (type == "Stop"s) {
+            if (!request_handler.FindStop(name) || content.count("road_distances") == 0
+                || !content.at("road_distances").IsDict()) {
+                throw JSONReaderError("Stop request at \"update_requests\" section format error."s);
+            }
+            request_handler.BuildStopIndex();       // once after a run of bus changes
+            const StopInfo buses = *request_handler.GetBusesByStop(name);     // distances don't change the view
+            for (const auto& [other_stop, distance] : content.at("road_distances").AsDict()) {
+                if (!request_handler.FindStop(other_stop)) {
+                    throw JSONReaderError("Unknown stop at \"update_requests\" section."s);
+                }
+                request_handler.SetDistance(name, other_stop, distance.AsInt());
+                // buses passing both stops may use the distance
+                const StopInfo other_buses = *request_handler.GetBusesByStop(other_stop);
+                vector<string_view> common_buses;
+                set_intersection(buses.begin(), buses.end(), other_buses.begin(), other_buses.end(),
+                                 back_inserter(common_buses));
+                for (const string_view bus_name : common_buses) {
+                    bus_ids.insert(request_handler.FindBus(bus_name)->id);
+                }
+            }
+        } else {
+            throw JSONReaderError("Unknown request at \"update_requests\" section."s);
+        }
+    }
+    return bus_ids;
+}
+
+/* Non-negative integer routing setting */
+size_t ParseSizeSetting(const json::Dict& settings, const string& key) {
+    const json::Node& value = settings.at(key);
+    if (!value.IsInt() || value.AsInt() < 0) {
+        throw JSONReaderError("\"routing_settings\" "s + key + " should be a non-negative integer."s);
+    }
+    return static_cast<size_t>(value.AsInt());
+}
+
 svg::Color ExtractColor(const json::Node& node) {
     if (node.IsString()) {
         return svg::Color(node.AsString());
@@ -247,7 +401,7 @@ svg::Color ExtractColor(const json::Node& node) {
 }
 
 json::Node 
-ProcessStopStatRequest (const json::Node& request, RequestHandler& request_handler) {
+ProcessStopStatRequest (const json::Node& request, const RequestHandler& request_handler) {
 
     const int id = request.AsDict().at("id").AsInt();
 
@@ -258,13 +412,12 @@ ProcessStopStatRequest (const json::Node& request, RequestHandler& request_handl
     
     auto info = request_handler.GetBusesByStop(name);
     if (info) {
+        // bus names are sorted in stop index
         json::Array buses;
+        buses.reserve(info->size());
         for (const auto& bus : *info) {
             buses.push_back(json::Node{string(bus)});
         }
-        sort(buses.begin(), buses.end(), 
-                [](const json::Node& lhs, const json::Node& rhs){
-                    return lhs.AsString() < rhs.AsString(); });
         
         return json::Builder{}
                     .StartDict()
@@ -284,7 +437,7 @@ ProcessStopStatRequest (const json::Node& request, RequestHandler& request_handl
 }
 
 json::Node 
-ProcessBusStatRequest (const json::Node& request, RequestHandler& request_handler) {
+ProcessBusStatRequest (const json::Node& request, const RequestHandler& request_handler) {
     const int id = request.AsDict().at("id").AsInt();
 
     if (request.AsDict().count("name") == 0) {
@@ -316,7 +469,7 @@ ProcessBusStatRequest (const json::Node& request, RequestHandler& request_handle
 
 json::Node 
 ProcessMapStatRequest (const json::Node& request, 
-                       renderer::MapRenderer& renderer, RequestHandler& request_handler) {
+                       renderer::MapRenderer& renderer, const RequestHandler& request_handler) {
     const int id = request.AsDict().at("id").AsInt();
 
     /* Map request { "type": "Map", "id": 11111 } */
@@ -330,9 +483,33 @@ ProcessMapStatRequest (const json::Node& request,
             .Build();
 }
 
+json::Array MakeJsonRouteItems(const transport_router::RouteItems& route) {
+    json::Array json_route_items;
+    for (const transport_router::RouteItem& item : route.items) {
+        json::Node stop = json::Builder()
+                                .StartDict()
+                                    .Key("type"s).Value("Wait"s)
+                                    .Key("stop_name"s).Value(string{item.from_stop})
+                                    .Key("time"s).Value(item.wait_time)
+                                .EndDict()
+                            .Build();
+        json_route_items.push_back(move(stop));
+        json::Node bus =  json::Builder()
+                                .StartDict()
+                                    .Key("type"s).Value("Bus"s)
+                                    .Key("bus"s).Value(string{item.bus})
+                                    .Key("span_count"s).Value(item.span_count)
+                                    .Key("time"s).Value(item.travel_time)
+                                .EndDict()
+                            .Build();
+        json_route_items.push_back(move(bus));
+    }
+    return json_route_items;
+}
+
 json::Node 
 ProcessRouteStatRequest (const json::Node& request, 
-                         transport_router::TransportRouter& transport_router) {
+                         const transport_router::TransportRouter& transport_router) {
     const int id = request.AsDict().at("id").AsInt();
 
     /* Route request {  "type": "Route", 
@@ -356,40 +533,211 @@ ProcessRouteStatRequest (const json::Node& request,
                 .Build();
     }
     
-    json::Array json_route_items;
-    for (const transport_router::RouteItem& item : route.value().items) {
-        json::Node stop = json::Builder()
+    json::Array json_route_items = MakeJsonRouteItems(*route);
+
+    return json::Builder{}
+                .StartDict()
+                    .Key("items"s).Value(json_route_items)
+                    .Key("request_id"s).Value(id)
+                    .Key("total_time"s).Value(route->total_time)
+                .EndDict()
+            .Build();
+}
+
+json::Node 
+ProcessRouteMatrixStatRequest (const json::Node& request, 
+                               const transport_router::TransportRouter& transport_router) {
+    const int id = request.AsDict().at("id").AsInt();
+
+    /* RouteMatrix request {  "type": "RouteMatrix", 
+                              "from": [ "Biryulyovo Zapadnoye", "Universam" ],
+                              "to": [ "Universam", "Tolstopaltsevo" ],
+                              "items": true,        (optional, default false)
+                              "id": 5 } */
+    const json::Dict& content = request.AsDict();
+    if (content.count("from") == 0 || !content.at("from").IsArray()
+        || content.count("to") == 0 || !content.at("to").IsArray()) {
+        throw JSONReaderError("\"stat_requests\" section format error."s);
+    }
+    vector<string> from, to;
+    for (const auto& name : content.at("from").AsArray()) {
+        from.push_back(name.AsString());
+    }
+    for (const auto& name : content.at("to").AsArray()) {
+        to.push_back(name.AsString());
+    }
+    const bool with_items = content.count("items") != 0 && content.at("items").AsBool();
+
+    /* routes[i][j] - route from[i] -> to[j]: { "total_time": 11.2, "items": [ ... ] }
+       or { "error_message": "not found" } */
+    json::Array json_routes;
+    for (const auto& row : transport_router.GetRouteMatrix(from, to)) {
+        json::Array json_row;
+        for (const transport_router::Route& route : row) {
+            if (!route) {
+                json_row.push_back(json::Builder{}
+                                        .StartDict()
+                                            .Key("error_message"s).Value("not found"s)
+                                        .EndDict()
+                                    .Build());
+            } else if (with_items) {
+                json_row.push_back(json::Builder{}
+                                        .StartDict()
+                                            .Key("items"s).Value(MakeJsonRouteItems(*route))
+                                            .Key("total_time"s).Value(route->total_time)
+                                        .EndDict()
+                                    .Build());
+            } else {
+                json_row.push_back(json::Builder{}
+                                        .StartDict()
+                                            .Key("total_time"s).Value(route->total_time)
+                                        .EndDict()
+                                    .Build());
+            }
+        }
+        json_routes.push_back(move(json_row));
+    }
+
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(id)
+                    .Key("routes"s).Value(move(json_routes))
+                .EndDict()
+            .Build();
+}
+
+json::Node 
+ProcessReachableStatRequest (const json::Node& request, 
+                             const transport_router::TransportRouter& transport_router) {
+    const int id = request.AsDict().at("id").AsInt();
+
+    /* Reachable request {  "type": "Reachable", 
+                            "from": "Biryulyovo Zapadnoye",
+                            "time_limit": 30,
+                            "id": 6 } */
+    const json::Dict& content = request.AsDict();
+    if (content.count("from") == 0 || content.count("time_limit") == 0 || !content.at("time_limit").IsDouble()) {
+        throw JSONReaderError("\"stat_requests\" section format error."s);
+    }
+    const string& from = content.at("from").AsString();
+    const double time_limit = content.at("time_limit").AsDouble();
+
+    transport_router::ReachableStops reachable = transport_router.GetReachableStops(from, time_limit);
+
+    if (!reachable) {
+        return json::Builder{}
+                    .StartDict()
+                        .Key("request_id"s).Value(id)
+                        .Key("error_message"s).Value("not found")
+                    .EndDict()
+                .Build();
+    }
+
+    /* stops: [ { "stop_name": "Universam", "time": 11.2 }, ... ] in order of time */
+    json::Array json_stops;
+    for (const auto& [stop, time] : *reachable) {
+        json_stops.push_back(json::Builder{}
                                 .StartDict()
-                                    .Key("type"s).Value("Wait"s)
-                                    .Key("stop_name"s).Value(string{item.from_stop})
-                                    .Key("time"s).Value(item.wait_time)
+                                    .Key("stop_name"s).Value(string{stop})
+                                    .Key("time"s).Value(time)
                                 .EndDict()
-                            .Build();
-        json_route_items.push_back(move(stop));
-        json::Node bus =  json::Builder()
+                            .Build());
+    }
+
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(id)
+                    .Key("stops"s).Value(move(json_stops))
+                .EndDict()
+            .Build();
+}
+
+json::Node 
+ProcessNearbyStatRequest (const json::Node& request, const RequestHandler& request_handler) {
+    const int id = request.AsDict().at("id").AsInt();
+
+    /* Nearby request {  "type": "Nearby", 
+                         "latitude": 55.611087,
+                         "longitude": 37.20829,
+                         "count": 5,
+                         "radius": 1000,
+                         "id": 7 }  count or radius or both */
+    const json::Dict& content = request.AsDict();
+    if (content.count("latitude") == 0 || !content.at("latitude").IsDouble()
+        || content.count("longitude") == 0 || !content.at("longitude").IsDouble()
+        || (content.count("count") == 0 && content.count("radius") == 0)
+        || (content.count("count") != 0 && (!content.at("count").IsInt() || content.at("count").AsInt() <= 0))
+        || (content.count("radius") != 0 && (!content.at("radius").IsDouble() || content.at("radius").AsDouble() < 0))) {
+        throw JSONReaderError("\"stat_requests\" section format error."s);
+    }
+    const geo::Coordinates center{content.at("latitude").AsDouble(), content.at("longitude").AsDouble()};
+    const size_t count = content.count("count") != 0 ? content.at("count").AsInt() : 0;
+    const double radius = content.count("radius") != 0 ? content.at("radius").AsDouble() : SpatialIndex::NO_RADIUS;
+
+    /* stops: [ { "stop_name": "Universam", "distance": 120.5 }, ... ] in order of distance */
+    json::Array json_stops;
+    for (const auto& [stop, distance] : request_handler.GetNearbyStops(center, count, radius)) {
+        json_stops.push_back(json::Builder{}
                                 .StartDict()
-                                    .Key("type"s).Value("Bus"s)
-                                    .Key("bus"s).Value(string{item.bus})
-                                    .Key("span_count"s).Value(item.span_count)
-                                    .Key("time"s).Value(item.travel_time)
+                                    .Key("stop_name"s).Value(string{stop->name})
+                                    .Key("distance"s).Value(distance)
                                 .EndDict()
-                            .Build();
-        json_route_items.push_back(move(bus));
+                            .Build());
     }
 
     return json::Builder{}
                 .StartDict()
-                    .Key("items"s).Value(json_route_items)
                     .Key("request_id"s).Value(id)
-                    .Key("total_time"s).Value(route->total_time)
+                    .Key("stops"s).Value(move(json_stops))
+                .EndDict()
+            .Build();
+}
+
+json::Node 
+ProcessSuggestStatRequest (const json::Node& request, const RequestHandler& request_handler) {
+    const int id = request.AsDict().at("id").AsInt();
+
+    /* Suggest request {  "type": "Suggest", 
+                          "query": "Biryu",
+                          "count": 5,
+                          "max_distance": 1,
+                          "id": 8 }  count and max_distance are optional */
+    const json::Dict& content = request.AsDict();
+    if (content.count("query") == 0 || !content.at("query").IsString()
+        || (content.count("count") != 0 && (!content.at("count").IsInt() || content.at("count").AsInt() <= 0))
+        || (content.count("max_distance") != 0
+            && (!content.at("max_distance").IsInt() || content.at("max_distance").AsInt() < 0))) {
+        throw JSONReaderError("\"stat_requests\" section format error."s);
+    }
+    static constexpr int DEFAULT_SUGGEST_COUNT = 10;
+    const string& query = content.at("query").AsString();
+    const size_t count = content.count("count") != 0 ? content.at("count").AsInt() : DEFAULT_SUGGEST_COUNT;
+    const size_t max_distance = content.count("max_distance") != 0 ? content.at("max_distance").AsInt() : 0;
+
+    /* items: [ { "name": "Biryulyovo Zapadnoye", "type": "Stop", "distance": 0 }, ... ] best first */
+    json::Array json_items;
+    for (const auto& [name, kind, distance] : request_handler.SuggestNames(query, count, max_distance)) {
+        json_items.push_back(json::Builder{}
+                                .StartDict()
+                                    .Key("name"s).Value(string{name})
+                                    .Key("type"s).Value(kind == NameKind::BUS ? "Bus"s : "Stop"s)
+                                    .Key("distance"s).Value(static_cast<int>(distance))
+                                .EndDict()
+                            .Build());
+    }
+
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(id)
+                    .Key("items"s).Value(move(json_items))
                 .EndDict()
             .Build();
 }
 
 json::Array ProcessStatRequest(const json::Array& stat_requests, 
                         renderer::MapRenderer& renderer,
-                        transport_router::TransportRouter& transport_router,
-                        RequestHandler& request_handler) {
+                        const SnapshotHolder& snapshots) {
+    using transport_router::TransportRouter;
     json::Array result{};
 
     for (const auto& request : stat_requests) {
@@ -398,6 +746,11 @@ json::Array ProcessStatRequest(const json::Array& stat_requests,
                        
             const string& type = request.AsDict().at("type").AsString();
 
+            // pinned snapshot is read without locks
+            const shared_ptr<const Snapshot> snapshot = snapshots.Get();
+            const RequestHandler& request_handler = snapshot->GetRequestHandler();
+            const TransportRouter& transport_router = snapshot->GetRouter();
+
             if (type == "Stop"s) {
                 result.push_back(ProcessStopStatRequest(request, request_handler));
             } else if (type == "Bus"s) {
@@ -406,6 +759,14 @@ json::Array ProcessStatRequest(const json::Array& stat_requests,
                 result.push_back(ProcessMapStatRequest(request, renderer, request_handler));
             } else if (type == "Route") {
                 result.push_back(ProcessRouteStatRequest(request, transport_router));
+            } else if (type == "RouteMatrix") {
+                result.push_back(ProcessRouteMatrixStatRequest(request, transport_router));
+            } else if (type == "Reachable") {
+                result.push_back(ProcessReachableStatRequest(request, transport_router));
+            } else if (type == "Nearby") {
+                result.push_back(ProcessNearbyStatRequest(request, request_handler));
+            } else if (type == "Suggest") {
+                result.push_back(ProcessSuggestStatRequest(request, request_handler));
             }
         } else {
             throw JSONReaderError("\"stat_requests\" section format error."s);   
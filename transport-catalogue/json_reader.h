@@ -6,8 +6,11 @@
  * Get answers from RequestHandler and output them as JSON
  */
 
+#include <unordered_set>
+
 #include "json.h"
 #include "serialization.h"
+#include "snapshot.h"
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "transport_router.h"
@@ -34,9 +37,10 @@ public:
 
     void MakeBase(RequestHandler& request_handler);
 
-    void ProcessStatRequests(renderer::MapRenderer& renderer, 
-                             transport_router::TransportRouter& transport_router,
-                             RequestHandler& request_handler);
+    void UpdateBase(RequestHandler& request_handler, transport_router::TransportRouter& transport_router);
+
+    /* Every request is answered from the snapshot published when the request starts */
+    void ProcessStatRequests(renderer::MapRenderer& renderer, const SnapshotHolder& snapshots);
     
 private:
     std::istream& input_;
@@ -48,27 +52,45 @@ namespace {
 
 void LoadStops(const json::Array& base_requests, RequestHandler& request_handler);
 void LoadBusesAndDistances(const json::Array& base_requests, RequestHandler& request_handler);
+std::unordered_set<size_t> ApplyUpdates(const json::Array& update_requests, RequestHandler& request_handler);
 
 json::Array ProcessStatRequest(const json::Array& stat_requests, 
                                renderer::MapRenderer& renderer,
-                               transport_router::TransportRouter& transport_router,
-                               RequestHandler& request_handler);
+                               const SnapshotHolder& snapshots);
+
+size_t ParseSizeSetting(const json::Dict& settings, const std::string& key);
 
 svg::Color ExtractColor(const json::Node& node);
 
 json::Node 
-ProcessStopStatRequest (const json::Node& request, RequestHandler& request_handler);
+ProcessStopStatRequest (const json::Node& request, const RequestHandler& request_handler);
 
 json::Node 
-ProcessBusStatRequest (const json::Node& request, RequestHandler& request_handler);
+ProcessBusStatRequest (const json::Node& request, const RequestHandler& request_handler);
 
 json::Node 
 ProcessMapStatRequest (const json::Node& request, 
-                       renderer::MapRenderer& renderer, RequestHandler& request_handler);
+                       renderer::MapRenderer& renderer, const RequestHandler& request_handler);
+
+json::Array MakeJsonRouteItems(const transport_router::RouteItems& route);
 
 json::Node 
 ProcessRouteStatRequest (const json::Node& request, 
-                         transport_router::TransportRouter& transport_router);
+                         const transport_router::TransportRouter& transport_router);
+
+json::Node 
+ProcessRouteMatrixStatRequest (const json::Node& request, 
+                               const transport_router::TransportRouter& transport_router);
+
+json::Node 
+ProcessReachableStatRequest (const json::Node& request, 
+                             const transport_router::TransportRouter& transport_router);
+
+json::Node 
+ProcessNearbyStatRequest (const json::Node& request, const RequestHandler& request_handler);
+
+json::Node 
+ProcessSuggestStatRequest (const json::Node& request, const RequestHandler& request_handler);
 
 } // namespace
 
@@ -0,0 +1,178 @@
+#pragma once
+
+/* Lazily filled all-pairs routes table. Row of origin vertex is computed by single-source Dijkstra
+ * on the first query from it and published by atomic compare-exchange, later queries from the origin
+ * are lookups. Queries may come from concurrent threads: published rows are immutable and are freed
+ * only with the router. When memory limit is reached new rows are not stored, queries from origins
+ * without row run Dijkstra every time.
+ */
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class LazyRouter {
+    static_assert(WeightTraits<Weight>::HAS_SCALAR_KEY, "Lazy router needs weights with scalar key");
+
+public:
+    using Graph = CsrGraph<Weight>;
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+    using Cell = PackedRoutesTable::Cell;
+
+    /* memory_limit - max size of stored rows, bytes (0 - no limit) */
+    explicit LazyRouter(const Graph& graph, size_t memory_limit = 0);
+    ~LazyRouter();
+
+    LazyRouter(const LazyRouter&) = delete;
+    LazyRouter& operator=(const LazyRouter&) = delete;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    size_t GetStoredRowCount() const;
+
+private:
+    /* routes from vertex, index = vertex_to */
+    std::unique_ptr<Cell[]> ComputeRow(VertexId from) const;
+    std::optional<RouteInfo> BuildRoute(const Cell* row, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    size_t max_row_count_;
+
+    mutable std::vector<std::atomic<const Cell*>> rows_;    /* index = vertex_from, nullptr - not computed */
+    mutable std::atomic<size_t> row_count_{0};              /* stored and reserved rows */
+};
+
+template <typename Weight>
+LazyRouter<Weight>::LazyRouter(const Graph& graph, size_t memory_limit)
+    : graph_(graph)
+    , rows_(graph.GetVertexCount())
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    if (edge_count >= PackedRoutesTable::NO_PREV_EDGE) {
+        throw std::length_error("Too many edges for packed routes rows");
+    }
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    for (auto& row : rows_) {
+        row.store(nullptr, std::memory_order_relaxed);
+    }
+    max_row_count_ = (memory_limit == 0 || vertex_count == 0) ? vertex_count
+                                                              : memory_limit / (vertex_count * sizeof(Cell));
+}
+
+template <typename Weight>
+LazyRouter<Weight>::~LazyRouter() {
+    for (auto& row : rows_) {
+        delete[] row.load(std::memory_order_acquire);
+    }
+}
+
+template <typename Weight>
+size_t LazyRouter<Weight>::GetStoredRowCount() const {
+    return std::count_if(rows_.begin(), rows_.end(), [](const std::atomic<const Cell*>& row) {
+        return row.load(std::memory_order_acquire) != nullptr;
+    });
+}
+
+/* Single-source Dijkstra over route keys */
+template <typename Weight>
+std::unique_ptr<typename LazyRouter<Weight>::Cell[]> LazyRouter<Weight>::ComputeRow(VertexId from) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<double> keys(vertex_count, std::numeric_limits<double>::infinity());
+    std::unique_ptr<Cell[]> row(new Cell[vertex_count]);
+    std::fill(row.get(), row.get() + vertex_count,
+              Cell{PackedRoutesTable::NO_ROUTE, PackedRoutesTable::NO_PREV_EDGE});
+    keys[from] = 0;
+
+    using QueueItem = std::pair<double, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({0, from});
+    while (!queue.empty()) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (keys[vertex] < key) continue;   // outdated queue item
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const double candidate = key + WeightTraits<Weight>::GetKey(edge.weight);
+            if (candidate < keys[edge.to]) {
+                keys[edge.to] = candidate;
+                row[edge.to].prev_edge = static_cast<uint32_t>(edge_id);
+                queue.push({candidate, edge.to});
+            }
+        }
+    }
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        row[vertex].weight = static_cast<float>(keys[vertex]);
+    }
+    return row;
+}
+
+template <typename Weight>
+std::optional<typename LazyRouter<Weight>::RouteInfo>
+LazyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= rows_.size() || to >= rows_.size()) {
+        throw std::out_of_range("Vertex id is out of graph");
+    }
+
+    const Cell* row = rows_[from].load(std::memory_order_acquire);
+    if (row) {
+        return BuildRoute(row, to);
+    }
+
+    std::unique_ptr<Cell[]> computed_row = ComputeRow(from);
+    // reserve place for the row, then publish it unless another thread has done it first
+    if (row_count_.fetch_add(1, std::memory_order_relaxed) < max_row_count_) {
+        const Cell* expected = nullptr;
+        if (rows_[from].compare_exchange_strong(expected, computed_row.get(), std::memory_order_acq_rel)) {
+            return BuildRoute(computed_row.release(), to);
+        }
+        row_count_.fetch_sub(1, std::memory_order_relaxed);
+        return BuildRoute(expected, to);
+    }
+    row_count_.fetch_sub(1, std::memory_order_relaxed);
+    return BuildRoute(computed_row.get(), to);
+}
+
+template <typename Weight>
+std::optional<typename LazyRouter<Weight>::RouteInfo>
+LazyRouter<Weight>::BuildRoute(const Cell* row, VertexId to) const {
+    if (!PackedRoutesTable::HasRoute(row[to])) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = row[to].prev_edge;
+         edge_id != PackedRoutesTable::NO_PREV_EDGE;
+         edge_id = row[graph_.GetEdge(edge_id).from].prev_edge)
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
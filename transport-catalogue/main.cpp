@@ -2,12 +2,14 @@
 #include <fstream>
 #include <string_view>
 #include <optional>
+#include <memory>
 
 #include "transport_catalogue.h"
 #include "json_reader.h"
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "snapshot.h"
 
 using namespace std::literals;
 using namespace transport_catalogue;
@@ -16,7 +18,7 @@ using transport_router::TransportRouter;
 using serialization::Serialization;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests|update_base]\n"sv;
 }
 
 void MakeBase() {
@@ -31,6 +33,10 @@ void MakeBase() {
     TransportRouter transport_router{request_handler};
     transport_router.SetSettings(*json_reader.ParseRouterSettings());
     transport_router.Initialize();
+    catalogue.BuildBusInfos(transport_router.ExportInternalState().settings.thread_count);
+    catalogue.BuildStopIndex();
+    catalogue.BuildSpatialIndex();
+    catalogue.BuildNameIndex();
 
     // serialize
     Serialization serialization{*json_reader.ParseSerializationSettings()};
@@ -38,34 +44,32 @@ void MakeBase() {
 }
 
 void ProcessRequests() {
-    TransportCatalogue catalogue{};
     JSONReader json_reader{std::cin, std::cout};
-
-    // containers for deserialization
-    std::optional<renderer::Renderer_Settings> renderer_settings;
-    std::optional<TransportRouter::Settings> router_settings;
-    std::unique_ptr<TransportRouter::Graph> ptr_graph = std::make_unique<TransportRouter::Graph>(0);
-    std::unique_ptr<TransportRouter::Router> ptr_router = std::make_unique<TransportRouter::Router>(*ptr_graph);
-    // deserialize
     Serialization serialization{*json_reader.ParseSerializationSettings()};
-    serialization.DeserializeTransportCatalogue(catalogue, 
-                                                renderer_settings,
-                                                router_settings,
-                                                *ptr_graph,
-                                                *ptr_router);
+
+    SnapshotHolder snapshots;
+    snapshots.Publish(Snapshot::Load(serialization));
 
     // start map renderer
     MapRenderer renderer{std::cout};
-    renderer.SetSettings(std::move(*renderer_settings));
-
-    // start transport router
-    RequestHandler request_handler{catalogue};
-    TransportRouter transport_router{request_handler};
-    transport_router.SetSettings(std::move(*router_settings));
-    transport_router.ExternalInitialization(std::move(ptr_graph), std::move(ptr_router));
+    renderer.SetSettings(renderer::Renderer_Settings{*snapshots.Get()->GetRendererSettings()});
 
     // process requests
-    json_reader.ProcessStatRequests(renderer, transport_router, request_handler);
+    json_reader.ProcessStatRequests(renderer, snapshots);
+}
+
+void UpdateBase() {
+    JSONReader json_reader{std::cin, std::cout};
+    Serialization serialization{*json_reader.ParseSerializationSettings()};
+
+    // update database and patch router
+    std::unique_ptr<Snapshot> snapshot = Snapshot::Load(serialization);
+    json_reader.UpdateBase(snapshot->GetRequestHandler(), snapshot->GetRouter());
+    snapshot->Freeze();
+
+    // serialize back
+    serialization.SerializeTransportCatalogue(snapshot->GetCatalogue(), snapshot->GetRouter(),
+                                              snapshot->GetRendererSettings());
 }
 
 int main(int argc, char* argv[]) {
@@ -77,6 +81,9 @@ int main(int argc, char* argv[]) {
         } else if (mode == "process_requests"sv) {
             ProcessRequests();
             return 0;
+        } else if (mode == "update_base"sv) {
+            UpdateBase();
+            return 0;
         }
     }
     
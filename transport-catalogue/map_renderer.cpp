@@ -176,7 +176,7 @@ void DrawPicture(const Container& container, svg::ObjectContainer& target) {
 MapRenderer::MapRenderer(std::ostream &output) : output_(output) {
 }
 
-svg::Document MapRenderer::RenderMap(RequestHandler &request_handler) const {
+svg::Document MapRenderer::RenderMap(const RequestHandler &request_handler) const {
 
     // get info about routes and translate them to map render
     const auto& buses = request_handler.GetAllBuses();
@@ -231,8 +231,8 @@ svg::Document MapRenderer::RenderMap(RequestHandler &request_handler) const {
     vector<string_view> stop_names;
     for (const auto& stop : stops) {
         // if no buses pass the stop, stop is not needed
-        if (request_handler.GetBusesByStop(stop.name).has_value()
-            && !request_handler.GetBusesByStop(stop.name).value().empty()) {
+        const auto buses = request_handler.GetBusesByStop(stop.name);
+        if (buses && !buses->empty()) {
             stop_names.push_back(string_view(stop.name));
         }
     }
@@ -77,7 +77,7 @@ public:
         return render_settings_;
     }
 
-    svg::Document RenderMap(RequestHandler& request_handler) const;
+    svg::Document RenderMap(const RequestHandler& request_handler) const;
 
 private:
     std::ostream& output_;
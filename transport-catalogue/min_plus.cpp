@@ -0,0 +1,120 @@
+#include "min_plus.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace min_plus {
+
+namespace {
+
+void RelaxRowScalar(double through_weight, EdgeId through_prev_edge,
+                    const double* weights_to, const EdgeId* prev_edges_to,
+                    double* weights, EdgeId* prev_edges, size_t count) {
+    for (size_t index = 0; index < count; ++index) {
+        const double candidate = through_weight + weights_to[index];
+        if (candidate < weights[index]) {
+            weights[index] = candidate;
+            prev_edges[index] = (prev_edges_to[index] != NO_EDGE) ? prev_edges_to[index] : through_prev_edge;
+        }
+    }
+}
+
+#ifdef MIN_PLUS_X86_SIMD
+
+static_assert(sizeof(EdgeId) == 8, "SIMD kernels expect 64-bit edge ids");
+
+__attribute__((target("avx2")))
+void RelaxRowAvx2(double through_weight, EdgeId through_prev_edge,
+                  const double* weights_to, const EdgeId* prev_edges_to,
+                  double* weights, EdgeId* prev_edges, size_t count) {
+    const __m256d through_weight_v = _mm256_set1_pd(through_weight);
+    const __m256i through_prev_edge_v = _mm256_set1_epi64x(static_cast<long long>(through_prev_edge));
+    const __m256i no_edge_v = _mm256_set1_epi64x(static_cast<long long>(NO_EDGE));
+
+    size_t index = 0;
+    for (; index + 4 <= count; index += 4) {
+        const __m256d candidate = _mm256_add_pd(through_weight_v, _mm256_loadu_pd(weights_to + index));
+        const __m256d current = _mm256_loadu_pd(weights + index);
+        const __m256d less = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(less) == 0) continue;
+
+        const __m256i prev_to = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_to + index));
+        const __m256i prev_to_missing = _mm256_cmpeq_epi64(prev_to, no_edge_v);
+        const __m256i new_prev = _mm256_blendv_epi8(prev_to, through_prev_edge_v, prev_to_missing);
+        const __m256i current_prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges + index));
+
+        _mm256_storeu_pd(weights + index, _mm256_blendv_pd(current, candidate, less));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges + index),
+                            _mm256_blendv_epi8(current_prev, new_prev, _mm256_castpd_si256(less)));
+    }
+    RelaxRowScalar(through_weight, through_prev_edge, weights_to + index, prev_edges_to + index,
+                   weights + index, prev_edges + index, count - index);
+}
+
+__attribute__((target("sse4.1")))
+void RelaxRowSse41(double through_weight, EdgeId through_prev_edge,
+                   const double* weights_to, const EdgeId* prev_edges_to,
+                   double* weights, EdgeId* prev_edges, size_t count) {
+    const __m128d through_weight_v = _mm_set1_pd(through_weight);
+    const __m128i through_prev_edge_v = _mm_set1_epi64x(static_cast<long long>(through_prev_edge));
+    const __m128i no_edge_v = _mm_set1_epi64x(static_cast<long long>(NO_EDGE));
+
+    size_t index = 0;
+    for (; index + 2 <= count; index += 2) {
+        const __m128d candidate = _mm_add_pd(through_weight_v, _mm_loadu_pd(weights_to + index));
+        const __m128d current = _mm_loadu_pd(weights + index);
+        const __m128d less = _mm_cmplt_pd(candidate, current);
+        if (_mm_movemask_pd(less) == 0) continue;
+
+        const __m128i prev_to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_to + index));
+        const __m128i prev_to_missing = _mm_cmpeq_epi64(prev_to, no_edge_v);
+        const __m128i new_prev = _mm_blendv_epi8(prev_to, through_prev_edge_v, prev_to_missing);
+        const __m128i current_prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + index));
+
+        _mm_storeu_pd(weights + index, _mm_blendv_pd(current, candidate, less));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + index),
+                         _mm_blendv_epi8(current_prev, new_prev, _mm_castpd_si128(less)));
+    }
+    RelaxRowScalar(through_weight, through_prev_edge, weights_to + index, prev_edges_to + index,
+                   weights + index, prev_edges + index, count - index);
+}
+
+#endif // MIN_PLUS_X86_SIMD
+
+using RelaxRowFunction = void (*)(double, EdgeId, const double*, const EdgeId*, double*, EdgeId*, size_t);
+
+/* select kernel by CPU features */
+RelaxRowFunction SelectKernel() {
+#ifdef MIN_PLUS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return RelaxRowAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return RelaxRowSse41;
+    }
+#endif
+    return RelaxRowScalar;
+}
+
+RelaxRowFunction GetKernel() {
+    static const RelaxRowFunction kernel = SelectKernel();
+    return kernel;
+}
+
+} // namespace
+
+void RelaxRow(double through_weight, EdgeId through_prev_edge,
+              const double* weights_to, const EdgeId* prev_edges_to,
+              double* weights, EdgeId* prev_edges, size_t count) {
+    GetKernel()(through_weight, through_prev_edge, weights_to, prev_edges_to,
+                weights, prev_edges, count);
+}
+
+} // namespace min_plus
+
+} // namespace graph
@@ -0,0 +1,32 @@
+#pragma once
+
+/* Min-plus row relaxation kernel for all-pairs routes precomputation.
+ * Implementations: AVX2, SSE4.1 and scalar. The best one supported by CPU is selected at runtime.
+ * All implementations do the same IEEE operations, so results are bit-identical.
+ */
+
+#include "graph.h"
+
+#include <cstdlib>
+#include <limits>
+
+namespace graph {
+
+namespace min_plus {
+
+/* prev edge of route without edges */
+inline constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+/* For every index in [0, count):
+       candidate = through_weight + weights_to[index]
+       if candidate < weights[index]:
+           weights[index] = candidate
+           prev_edges[index] = (prev_edges_to[index] != NO_EDGE) ? prev_edges_to[index] : through_prev_edge
+   Missing routes have +infinity weight */
+void RelaxRow(double through_weight, EdgeId through_prev_edge,
+              const double* weights_to, const EdgeId* prev_edges_to,
+              double* weights, EdgeId* prev_edges, size_t count);
+
+} // namespace min_plus
+
+} // namespace graph
@@ -0,0 +1,246 @@
+#include "name_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace domain {
+
+using namespace std;
+
+namespace {
+
+/* Add byte of UTF-8 text to code point being decoded. remaining - bytes left of the code point.
+   Returns true when the code point is complete. Stray continuation byte is a code point itself */
+bool PushUtf8Byte(uint32_t& code_point, size_t& remaining, unsigned char byte) {
+    if (remaining == 0) {
+        if (byte < 0xC0) {
+            code_point = byte;
+        } else if (byte < 0xE0) {
+            code_point = byte & 0x1F;
+            remaining = 1;
+        } else if (byte < 0xF0) {
+            code_point = byte & 0x0F;
+            remaining = 2;
+        } else {
+            code_point = byte & 0x07;
+            remaining = 3;
+        }
+    } else {
+        code_point = (code_point << 6) | (byte & 0x3F);
+        --remaining;
+    }
+    return remaining == 0;
+}
+
+vector<uint32_t> DecodeUtf8(string_view text) {
+    vector<uint32_t> code_points;
+    uint32_t code_point = 0;
+    size_t remaining = 0;
+    for (const char c : text) {
+        if (PushUtf8Byte(code_point, remaining, static_cast<unsigned char>(c))) {
+            code_points.push_back(code_point);
+        }
+    }
+    if (remaining != 0) code_points.push_back(code_point);    // truncated last code point
+    return code_points;
+}
+
+/* Depth-first search keeping Levenshtein row of query against path to node */
+class SimilarSearch {
+public:
+    SimilarSearch(const NameIndex::Data& data, const vector<uint32_t>& query, size_t max_distance)
+        : data_(data)
+        , query_(query)
+        , max_distance_(max_distance)
+    {
+    }
+
+    /* (distance, entry index) of matching entries */
+    vector<pair<size_t, uint32_t>> Run() {
+        vector<size_t> row(query_.size() + 1);
+        iota(row.begin(), row.end(), 0);
+        Visit(0, row, row.back(), 0, 0);
+        return move(matches_);
+    }
+
+private:
+    /* row and best distance are of path to node, code point is incomplete if remaining != 0 */
+    void Visit(uint32_t node, const vector<size_t>& row, size_t best, uint32_t code_point, size_t remaining) {
+        if (remaining == 0 && best <= max_distance_) {
+            for (uint32_t entry = data_.entry_offsets[node]; entry < data_.entry_offsets[node + 1]; ++entry) {
+                matches_.emplace_back(best, entry);
+            }
+        }
+        if (best > max_distance_ && *min_element(row.begin(), row.end()) > max_distance_) return;
+
+        for (uint32_t child = node + 1; child < data_.subtree_ends[node]; child = data_.subtree_ends[child]) {
+            uint32_t child_code_point = code_point;
+            size_t child_remaining = remaining;
+            if (!PushUtf8Byte(child_code_point, child_remaining, static_cast<unsigned char>(data_.labels[child]))) {
+                Visit(child, row, best, child_code_point, child_remaining);
+                continue;
+            }
+            vector<size_t> child_row(row.size());
+            child_row[0] = row[0] + 1;
+            for (size_t i = 1; i < row.size(); ++i) {
+                child_row[i] = min({row[i] + 1, child_row[i - 1] + 1,
+                                    row[i - 1] + (query_[i - 1] == child_code_point ? 0 : 1)});
+            }
+            Visit(child, child_row, min(best, child_row.back()), 0, 0);
+        }
+    }
+
+    const NameIndex::Data& data_;
+    const vector<uint32_t>& query_;
+    size_t max_distance_;
+    vector<pair<size_t, uint32_t>> matches_;
+};
+
+} // namespace
+
+void NameIndex::Build(vector<Entry> entries, const StringPool& names) {
+    sort(entries.begin(), entries.end(), [&names](const Entry& lhs, const Entry& rhs) {
+        return pair{names.Get(lhs.name), lhs.kind} < pair{names.Get(rhs.name), rhs.kind};
+    });
+
+    data_ = Data{};
+    is_built_ = true;
+    data_.labels.push_back('\0');
+    data_.subtree_ends.push_back(0);
+    data_.entry_offsets.push_back(0);
+
+    // names are sorted, so nodes are created in preorder; path - nodes from root to previous name
+    vector<uint32_t> path{0};
+    string_view previous;
+    for (const Entry& entry : entries) {
+        const string_view name = names.Get(entry.name);
+        const size_t common = mismatch(previous.begin(), previous.end(), name.begin(), name.end()).first
+                              - previous.begin();
+        for (; path.size() > common + 1; path.pop_back()) {
+            data_.subtree_ends[path.back()] = static_cast<uint32_t>(data_.labels.size());
+        }
+        for (size_t i = common; i < name.size(); ++i) {
+            if (data_.labels.size() >= numeric_limits<uint32_t>::max()) {
+                throw length_error("Too many nodes in name index");
+            }
+            path.push_back(static_cast<uint32_t>(data_.labels.size()));
+            data_.labels.push_back(name[i]);
+            data_.subtree_ends.push_back(0);
+            data_.entry_offsets.push_back(static_cast<uint32_t>(data_.entries.size()));
+        }
+        data_.entries.push_back(entry);
+        previous = name;
+    }
+    for (const uint32_t node : path) {
+        data_.subtree_ends[node] = static_cast<uint32_t>(data_.labels.size());
+    }
+    data_.entry_offsets.push_back(static_cast<uint32_t>(data_.entries.size()));
+
+    // children follow parents in preorder, so subtree maximums are collected backwards
+    data_.max_weights.assign(data_.labels.size(), 0);
+    for (size_t node = data_.labels.size(); node-- > 0;) {
+        uint32_t& max_weight = data_.max_weights[node];
+        for (uint32_t entry = data_.entry_offsets[node]; entry < data_.entry_offsets[node + 1]; ++entry) {
+            max_weight = max(max_weight, data_.entries[entry].weight);
+        }
+        for (uint32_t child = node + 1; child < data_.subtree_ends[node]; child = data_.subtree_ends[child]) {
+            max_weight = max(max_weight, data_.max_weights[child]);
+        }
+    }
+}
+
+void NameIndex::Load(Data&& data) {
+    const size_t node_count = data.labels.size();
+    bool is_consistent = node_count > 0
+        && data.subtree_ends.size() == node_count && data.max_weights.size() == node_count
+        && data.entry_offsets.size() == node_count + 1
+        && data.entry_offsets.front() == 0 && data.entry_offsets.back() == data.entries.size()
+        && is_sorted(data.entry_offsets.begin(), data.entry_offsets.end());
+    for (size_t node = 0; is_consistent && node < node_count; ++node) {
+        is_consistent = data.subtree_ends[node] > node && data.subtree_ends[node] <= node_count;
+    }
+    if (!is_consistent) {
+        throw invalid_argument("Name index data is inconsistent");
+    }
+    data_ = move(data);
+    is_built_ = true;
+}
+
+const NameIndex::Data& NameIndex::GetData() const {
+    return data_;
+}
+
+bool NameIndex::IsBuilt() const {
+    return is_built_;
+}
+
+void NameIndex::Clear() {
+    data_ = Data{};
+    is_built_ = false;
+}
+
+vector<NameIndex::Match> NameIndex::Find(string_view query, size_t count, size_t max_distance) const {
+    if (data_.labels.empty()) return {};
+    return max_distance == 0 ? FindByPrefix(query, count) : FindSimilar(query, count, max_distance);
+}
+
+vector<NameIndex::Match> NameIndex::FindByPrefix(string_view prefix, size_t count) const {
+    vector<Match> result;
+
+    uint32_t node = 0;
+    for (const char c : prefix) {
+        uint32_t child = node + 1;
+        while (child < data_.subtree_ends[node] && data_.labels[child] != c) {
+            child = data_.subtree_ends[child];
+        }
+        if (child == data_.subtree_ends[node]) return result;
+        node = child;
+    }
+
+    // queue items: (weight, -position, is entry, index). Node key bounds weights and positions
+    // of its subtree entries, so entries are popped by weight descending, then by name
+    using Item = tuple<uint32_t, int64_t, bool, uint32_t>;
+    priority_queue<Item> queue;
+    queue.emplace(data_.max_weights[node], -int64_t{data_.entry_offsets[node]}, false, node);
+    while (!queue.empty() && (count == 0 || result.size() < count)) {
+        const auto [weight, position, is_entry, index] = queue.top();
+        queue.pop();
+        if (is_entry) {
+            result.push_back(Match{data_.entries[index], 0});
+            continue;
+        }
+        for (uint32_t entry = data_.entry_offsets[index]; entry < data_.entry_offsets[index + 1]; ++entry) {
+            queue.emplace(data_.entries[entry].weight, -int64_t{entry}, true, entry);
+        }
+        for (uint32_t child = index + 1; child < data_.subtree_ends[index]; child = data_.subtree_ends[child]) {
+            queue.emplace(data_.max_weights[child], -int64_t{data_.entry_offsets[child]}, false, child);
+        }
+    }
+    return result;
+}
+
+vector<NameIndex::Match> NameIndex::FindSimilar(string_view query, size_t count, size_t max_distance) const {
+    const vector<uint32_t> code_points = DecodeUtf8(query);
+    vector<pair<size_t, uint32_t>> matches = SimilarSearch{data_, code_points, max_distance}.Run();
+
+    const auto is_better = [this](const pair<size_t, uint32_t>& lhs, const pair<size_t, uint32_t>& rhs) {
+        return tuple{lhs.first, data_.entries[rhs.second].weight, lhs.second}
+             < tuple{rhs.first, data_.entries[lhs.second].weight, rhs.second};
+    };
+    const size_t result_size = count == 0 ? matches.size() : min(count, matches.size());
+    partial_sort(matches.begin(), matches.begin() + result_size, matches.end(), is_better);
+
+    vector<Match> result;
+    result.reserve(result_size);
+    for (size_t i = 0; i < result_size; ++i) {
+        result.push_back(Match{data_.entries[matches[i].second], matches[i].first});
+    }
+    return result;
+}
+
+} // namespace domain
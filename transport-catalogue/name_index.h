@@ -0,0 +1,71 @@
+#pragma once
+
+/* Trie over stop and bus names for name suggestions. Nodes are stored in preorder in flat arrays,
+ * so the subtree of node i is nodes [i, subtree_ends[i]) and names of the subtree are
+ * entries [entry_offsets[i], entry_offsets[subtree_ends[i]]); children of node i are i + 1,
+ * subtree_ends[i + 1], ... Arrays have no pointers, so index is stored in the base as is.
+ * Edges are labeled by bytes of UTF-8 names, edit distance is counted in code points.
+ * Every name has a weight, among names at equal edit distance heavier names go first.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "domain.h"
+#include "string_pool.h"
+
+namespace domain {
+
+class NameIndex {
+public:
+    struct Entry {
+        StringPool::Handle name;
+        NameKind kind = NameKind::STOP;
+        uint32_t weight = 0;
+    };
+
+    struct Match {
+        Entry entry;
+        size_t distance;        /* edit distance from the query to the closest prefix of name */
+    };
+
+    /* trie nodes in preorder and entries in order of names */
+    struct Data {
+        std::string labels;                     /* byte of edge to node, index = node */
+        std::vector<uint32_t> subtree_ends;     /* index = node */
+        std::vector<uint32_t> max_weights;      /* max weight of subtree entries, index = node */
+        std::vector<uint32_t> entry_offsets;    /* entries of node i = entries[offsets[i], offsets[i + 1]) */
+        std::vector<Entry> entries;
+    };
+
+    /* names - pool the entries' names are in */
+    void Build(std::vector<Entry> entries, const StringPool& names);
+
+    /* Replace index by loaded one, throws std::invalid_argument if data is inconsistent */
+    void Load(Data&& data);
+
+    const Data& GetData() const;
+
+    bool IsBuilt() const;
+
+    void Clear();
+
+    /* At most count names having a prefix within max_distance edits from query.
+       Sorted by distance, then by weight descending, then by name */
+    std::vector<Match> Find(std::string_view query, size_t count, size_t max_distance = 0) const;
+
+private:
+    /* names starting with prefix, best-first search by subtree max weights */
+    std::vector<Match> FindByPrefix(std::string_view prefix, size_t count) const;
+
+    /* depth-first search with Levenshtein row per node */
+    std::vector<Match> FindSimilar(std::string_view query, size_t count, size_t max_distance) const;
+
+    Data data_;
+    bool is_built_ = false;
+};
+
+} // namespace domain
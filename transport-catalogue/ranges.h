@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view>
 #include <unordered_map>
@@ -22,6 +23,12 @@ public:
     It end() const {
         return end_;
     }
+    bool empty() const {
+        return begin_ == end_;
+    }
+    size_t size() const {
+        return static_cast<size_t>(std::distance(begin_, end_));
+    }
 
 private:
     It begin_;
@@ -33,4 +40,45 @@ auto AsRange(const C& container) {
     return Range{container.begin(), container.end()};
 }
 
+/* Iterates over consecutive integer values, dereferences to the value itself */
+template <typename Integer>
+class IndexIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Integer;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Integer*;
+    using reference = Integer;
+
+    explicit IndexIterator(Integer value) : value_(value) {
+    }
+    Integer operator*() const {
+        return value_;
+    }
+    IndexIterator& operator++() {
+        ++value_;
+        return *this;
+    }
+    IndexIterator operator++(int) {
+        IndexIterator result = *this;
+        ++value_;
+        return result;
+    }
+    bool operator==(const IndexIterator& other) const {
+        return value_ == other.value_;
+    }
+    bool operator!=(const IndexIterator& other) const {
+        return value_ != other.value_;
+    }
+
+private:
+    Integer value_;
+};
+
+/* Range of integer values [begin, end) */
+template <typename Integer>
+auto AsIndexRange(Integer begin, Integer end) {
+    return Range{IndexIterator<Integer>{begin}, IndexIterator<Integer>{end}};
+}
+
 }  // namespace ranges
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace transport_catalogue {
+
+namespace transport_router {
+
+using namespace std;
+
+namespace {
+
+constexpr double INF = numeric_limits<double>::infinity();
+
+} // namespace
+
+RaptorRouter::RaptorRouter(size_t stops_count, double wait_time, vector<BusTrace>&& traces,
+                           optional<size_t> max_transfers)
+    : wait_time_(wait_time)
+    , max_rounds_(max_transfers ? *max_transfers + 1 : NONE)
+    , stops_count_(stops_count)
+    , traces_(move(traces))
+    , stop_events_offsets_(stops_count + 1, 0)
+{
+    // counting sort of trace positions by stop
+    for (const auto& trace : traces_) {
+        for (const graph::VertexId stop : trace.stops) {
+            ++stop_events_offsets_[stop + 1];
+        }
+    }
+    for (size_t stop = 0; stop < stops_count; ++stop) {
+        stop_events_offsets_[stop + 1] += stop_events_offsets_[stop];
+    }
+    stop_events_.resize(stop_events_offsets_.back());
+    vector<size_t> fill(stop_events_offsets_.begin(), stop_events_offsets_.end() - 1);
+    for (size_t trace_index = 0; trace_index < traces_.size(); ++trace_index) {
+        const auto& stops = traces_[trace_index].stops;
+        for (size_t position = 0; position < stops.size(); ++position) {
+            stop_events_[fill[stops[position]]++] = StopEvent{trace_index, position};
+        }
+    }
+}
+
+/* Labels are shared by routers of all snapshots used in the thread. Leftovers are reset before
+   the query, not after, so labels left by a query interrupted with exception are reset too */
+RaptorRouter::SearchLabels& RaptorRouter::GetSearchLabels() const {
+    thread_local SearchLabels labels;
+    ResetLabels(labels);
+    if (labels.stops_count != stops_count_) {
+        labels.round_labels.clear();
+        labels.stops_count = stops_count_;
+    }
+    if (labels.round_labels.empty()) labels.round_labels.resize(stops_count_, Label{INF, {}});
+    if (labels.arrivals.size() < stops_count_) {
+        labels.arrivals.resize(stops_count_, INF);
+        labels.boarding_arrivals.resize(stops_count_, INF);
+        labels.is_marked.resize(stops_count_, false);
+    }
+    if (labels.first_positions.size() < traces_.size()) labels.first_positions.resize(traces_.size(), NONE);
+    return labels;
+}
+
+void RaptorRouter::ResetLabels(SearchLabels& labels) {
+    for (const graph::VertexId stop : labels.reached_stops) {
+        labels.arrivals[stop] = INF;
+        labels.boarding_arrivals[stop] = INF;
+    }
+    for (const size_t index : labels.labeled) {
+        labels.round_labels[index].arrival = INF;
+    }
+    for (const graph::VertexId stop : labels.marked_stops) {
+        labels.is_marked[stop] = false;
+    }
+    for (const size_t trace_index : labels.queued_traces) {
+        labels.first_positions[trace_index] = NONE;
+    }
+    labels.reached_stops.clear();
+    labels.labeled.clear();
+    labels.marked_stops.clear();
+    labels.queued_traces.clear();
+}
+
+/* Ride the bus along trace, boarding at the position with the least (previous round arrival + wait - time) */
+void RaptorRouter::ScanTrace(SearchLabels& labels, size_t trace_index, size_t round,
+                             graph::VertexId to, double time_limit) const {
+    const BusTrace& trace = traces_[trace_index];
+    vector<double>& arrivals = labels.arrivals;
+    double on_bus = INF;            /* arrival at first stop of trace if we were on the bus */
+    size_t board_position = NONE;
+
+    for (size_t position = labels.first_positions[trace_index]; position < trace.stops.size(); ++position) {
+        const graph::VertexId stop = trace.stops[position];
+        if (board_position != NONE) {
+            const double arrival = on_bus + trace.times[position];
+            // local, target and time limit pruning
+            if (arrival < arrivals[stop] && (to == NONE || arrival < arrivals[to]) && arrival <= time_limit) {
+                if (arrivals[stop] == INF) labels.reached_stops.push_back(stop);
+                arrivals[stop] = arrival;
+                const size_t index = round * stops_count_ + stop;
+                if (labels.round_labels[index].arrival == INF) labels.labeled.push_back(index);
+                labels.round_labels[index] = Label{arrival, Parent{trace_index, board_position, position}};
+                if (!labels.is_marked[stop]) {
+                    labels.is_marked[stop] = true;
+                    labels.marked_stops.push_back(stop);
+                }
+            }
+        }
+        if (labels.boarding_arrivals[stop] != INF) {
+            const double candidate = labels.boarding_arrivals[stop] + wait_time_ - trace.times[position];
+            if (candidate < on_bus) {
+                on_bus = candidate;
+                board_position = position;
+            }
+        }
+    }
+}
+
+void RaptorRouter::Search(SearchLabels& labels, graph::VertexId from, graph::VertexId to, double time_limit) const {
+    labels.arrivals[from] = 0;
+    labels.round_labels[from].arrival = 0;
+    labels.labeled.push_back(from);
+    labels.reached_stops.push_back(from);
+    labels.marked_stops.push_back(from);
+    labels.is_marked[from] = true;
+
+    // one round per bus trip, trips of round k board at stops improved by round k - 1
+    size_t round = 0;
+    while (!labels.marked_stops.empty() && round < max_rounds_) {
+        ++round;
+        if (labels.round_labels.size() < (round + 1) * stops_count_) {
+            labels.round_labels.resize((round + 1) * stops_count_, Label{INF, {}});
+        }
+        for (const graph::VertexId stop : labels.marked_stops) {
+            labels.is_marked[stop] = false;
+            labels.boarding_arrivals[stop] = labels.arrivals[stop];
+            for (size_t i = stop_events_offsets_[stop]; i < stop_events_offsets_[stop + 1]; ++i) {
+                const auto [trace_index, position] = stop_events_[i];
+                size_t& first_position = labels.first_positions[trace_index];
+                if (first_position == NONE) labels.queued_traces.push_back(trace_index);
+                first_position = min(first_position, position);
+            }
+        }
+        labels.marked_stops.clear();
+
+        for (const size_t trace_index : labels.queued_traces) {
+            ScanTrace(labels, trace_index, round, to, time_limit);
+            labels.first_positions[trace_index] = NONE;
+        }
+        labels.queued_traces.clear();
+    }
+    labels.rounds_count = round;
+}
+
+/* Unwind trips from destination to source. Arrival of stop by round k is its label of the last round <= k
+   it is improved in, trip of round k boards with arrival by round k - 1 */
+optional<RaptorRouter::RouteInfo> RaptorRouter::UnwindRoute(const SearchLabels& labels,
+                                                            graph::VertexId from, graph::VertexId to) const {
+    if (labels.arrivals[to] == INF) return nullopt;
+
+    RouteInfo result{labels.arrivals[to], {}};
+    size_t round = labels.rounds_count;
+    for (graph::VertexId stop = to; stop != from; --round) {
+        while (labels.round_labels[round * stops_count_ + stop].arrival == INF) --round;
+        const Parent& parent = labels.round_labels[round * stops_count_ + stop].parent;
+        const BusTrace& trace = traces_[parent.trace_index];
+        result.trips.push_back(Trip{trace.bus_id,
+                                    trace.stops[parent.board_position],
+                                    stop,
+                                    static_cast<int>(parent.alight_position - parent.board_position),
+                                    trace.times[parent.alight_position] - trace.times[parent.board_position]});
+        stop = trace.stops[parent.board_position];
+    }
+    reverse(result.trips.begin(), result.trips.end());
+    return result;
+}
+
+optional<RaptorRouter::RouteInfo> RaptorRouter::BuildRoute(graph::VertexId from, graph::VertexId to) const {
+    SearchLabels& labels = GetSearchLabels();
+    Search(labels, from, to, INF);
+    return UnwindRoute(labels, from, to);
+}
+
+vector<optional<RaptorRouter::RouteInfo>> RaptorRouter::BuildRoutes(graph::VertexId from,
+                                                                    const vector<graph::VertexId>& to) const {
+    SearchLabels& labels = GetSearchLabels();
+    Search(labels, from, NONE, INF);
+    vector<optional<RouteInfo>> result;
+    result.reserve(to.size());
+    for (const graph::VertexId stop : to) {
+        result.push_back(UnwindRoute(labels, from, stop));
+    }
+    return result;
+}
+
+vector<pair<graph::VertexId, double>> RaptorRouter::FindReachable(graph::VertexId from, double time_limit) const {
+    if (!(time_limit >= 0)) return {};
+
+    SearchLabels& labels = GetSearchLabels();
+    Search(labels, from, NONE, time_limit);
+    vector<pair<graph::VertexId, double>> result;
+    result.reserve(labels.reached_stops.size());
+    for (const graph::VertexId stop : labels.reached_stops) {
+        result.emplace_back(stop, labels.arrivals[stop]);
+    }
+    sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second < rhs.second;
+    });
+    return result;
+}
+
+} // namespace transport_router
+
+} // namespace transport_catalogue
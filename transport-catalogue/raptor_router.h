@@ -0,0 +1,114 @@
+#pragma once
+
+/* Round-based route engine in the style of RAPTOR. Works on bus traces directly, without graph.
+ * Round k scans buses passing through stops improved in round k - 1 and boards them only with
+ * arrivals of round k - 1, so it finds the best routes with at most k bus trips. Labels are kept
+ * per round, so the route is unwound with the trips count it was found with, and the search stops
+ * after max_transfers + 1 rounds. Trace travel times are kept as prefix sums, so trip time between
+ * any two positions of a bus is a single subtraction. Round labels live in per-thread workspace,
+ * router itself is read only after construction.
+ */
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+
+namespace transport_catalogue {
+
+namespace transport_router {
+
+class RaptorRouter {
+public:
+    /* Bus trace: stops sequence and travel time from first stop of trace, minutes */
+    struct BusTrace {
+        size_t bus_id;
+        std::vector<graph::VertexId> stops;
+        std::vector<double> times;
+    };
+
+    /* One bus trip of route */
+    struct Trip {
+        size_t bus_id;
+        graph::VertexId from;
+        graph::VertexId to;
+        int span_count;
+        double travel_time;
+    };
+
+    struct RouteInfo {
+        double total_time;
+        std::vector<Trip> trips;
+    };
+
+    /* max_transfers - bus changes allowed on route, nullopt - no limit */
+    RaptorRouter(size_t stops_count, double wait_time, std::vector<BusTrace>&& traces,
+                 std::optional<size_t> max_transfers = std::nullopt);
+
+    std::optional<RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+    /* Routes from one stop to many, with single search */
+    std::vector<std::optional<RouteInfo>> BuildRoutes(graph::VertexId from,
+                                                      const std::vector<graph::VertexId>& to) const;
+    /* Stops reachable within time limit and their arrival times, in order of time */
+    std::vector<std::pair<graph::VertexId, double>> FindReachable(graph::VertexId from, double time_limit) const;
+
+private:
+    /* Bus trace position of the stop */
+    struct StopEvent {
+        size_t trace_index;
+        size_t position;
+    };
+
+    /* Trip which gives stop arrival label */
+    struct Parent {
+        size_t trace_index;
+        size_t board_position;
+        size_t alight_position;
+    };
+
+    /* Stop arrival of the round and the trip which gives it */
+    struct Label {
+        double arrival;
+        Parent parent;
+    };
+
+    /* flat per-stop search labels, reused between queries of the thread */
+    struct SearchLabels {
+        size_t stops_count = 0;                         /* round labels layout */
+        std::vector<double> arrivals;                   /* best arrival of any round */
+        std::vector<double> boarding_arrivals;          /* arrival by the end of previous round */
+        std::vector<Label> round_labels;                /* index = round * stops count + stop */
+        std::vector<size_t> labeled;                    /* round labels indexes, for reset */
+        size_t rounds_count = 0;                        /* rounds of the last search */
+        std::vector<char> is_marked;
+        std::vector<graph::VertexId> marked_stops;
+        std::vector<graph::VertexId> reached_stops;     /* stops with finite label, for reset */
+        std::vector<size_t> first_positions;            /* index = trace index, first position to scan */
+        std::vector<size_t> queued_traces;
+    };
+
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    /* Labels of calling thread with previous query leftovers reset, sized to the router */
+    SearchLabels& GetSearchLabels() const;
+    static void ResetLabels(SearchLabels& labels);
+    /* to == NONE - search to all stops, arrivals later than time_limit are pruned */
+    void Search(SearchLabels& labels, graph::VertexId from, graph::VertexId to, double time_limit) const;
+    void ScanTrace(SearchLabels& labels, size_t trace_index, size_t round,
+                   graph::VertexId to, double time_limit) const;
+    std::optional<RouteInfo> UnwindRoute(const SearchLabels& labels,
+                                         graph::VertexId from, graph::VertexId to) const;
+
+    double wait_time_;
+    size_t max_rounds_;                         /* NONE - no limit */
+    size_t stops_count_;
+    std::vector<BusTrace> traces_;
+    std::vector<size_t> stop_events_offsets_;     /* index = stop id, CSR offsets to stop_events_ */
+    std::vector<StopEvent> stop_events_;
+};
+
+} // namespace transport_router
+
+} // namespace transport_catalogue
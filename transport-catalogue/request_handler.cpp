@@ -7,14 +7,22 @@ using namespace std;
 RequestHandler::RequestHandler(TransportCatalogue& db) : db_(db) {
 }
 
-void RequestHandler::AddStop(const std::string &name, const geo::Coordinates &coordinates) {
+void RequestHandler::AddStop(const std::string_view name, const geo::Coordinates &coordinates) {
     db_.AddStop(name, coordinates);
 }
 
-void RequestHandler::AddBus(const std::string &name, BusType type, const std::vector<std::string> &stops) {
+void RequestHandler::AddBus(const std::string_view name, BusType type, const std::vector<std::string> &stops) {
     db_.AddBus(name, type, stops);
 }
 
+bool RequestHandler::RemoveBus(const std::string_view bus_name) {
+    return db_.RemoveBus(bus_name);
+}
+
+void RequestHandler::BuildStopIndex() {
+    db_.BuildStopIndex();
+}
+
 void RequestHandler::SetDistance(const std::string &from_stop, const std::string &to_stop, const int distance) {
     db_.SetDistance(from_stop, to_stop, distance);
 }
@@ -47,8 +55,7 @@ const Bus* RequestHandler::FindBus(const size_t id) const {
 optional<const StopInfo> RequestHandler::GetBusesByStop(const string_view& stop_name) const {
     const Stop* stop = db_.FindStop(stop_name);
     if (stop) {
-        const StopInfo& info = db_.GetStopInfo(stop_name);
-        return optional<const StopInfo>{info};
+        return optional<const StopInfo>{db_.GetStopInfo(stop_name)};
     }
     return nullopt;
 }
@@ -69,4 +76,14 @@ int RequestHandler::GetDistance(const size_t from_stop_id, const size_t to_stop_
     return db_.GetDistance(from_stop_id, to_stop_id);
 }
 
+std::vector<std::pair<const Stop*, double>>
+RequestHandler::GetNearbyStops(geo::Coordinates center, size_t count, double radius) const {
+    return db_.FindNearbyStops(center, count, radius);
+}
+
+std::vector<NameSuggestion>
+RequestHandler::SuggestNames(const std::string_view query, size_t count, size_t max_distance) const {
+    return db_.SuggestNames(query, count, max_distance);
+}
+
 } // namespace transport_catalogue
\ No newline at end of file
@@ -18,14 +18,20 @@ public:
     explicit RequestHandler(TransportCatalogue& db);
 
     /* Add Stop to database */
-    void AddStop(const std::string& name, const geo::Coordinates& coordinates);
+    void AddStop(const std::string_view name, const geo::Coordinates& coordinates);
 
     /* Add Route to database */
-    void AddBus(const std::string& name, BusType type, const std::vector<std::string>& stops);
+    void AddBus(const std::string_view name, BusType type, const std::vector<std::string>& stops);
 
     /* Add Distance (between Stops) to database */
     void SetDistance(const std::string& from_stop, const std::string& to_stop, const int distance);
 
+    /* Remove Route from database */
+    bool RemoveBus(const std::string_view bus_name);
+
+    /* Rebuild stop-to-buses index after Stops or Buses are changed */
+    void BuildStopIndex();
+
     // Возвращает информацию о маршруте (запрос Bus)
     std::optional<const BusInfo> GetBusStat(const std::string_view& bus_name) const;
     
@@ -56,6 +62,13 @@ public:
     /* Get distance between two Stops in meters (if set) */
     int GetDistance(const size_t from_stop_id, const size_t to_stop_id) const;
 
+    /* Stops not farther than radius meters from center, at most count nearest of them (0 - no limit) */
+    std::vector<std::pair<const Stop*, double>>
+    GetNearbyStops(geo::Coordinates center, size_t count, double radius) const;
+
+    /* Stop and Bus names for a search box, see TransportCatalogue::SuggestNames */
+    std::vector<NameSuggestion> SuggestNames(const std::string_view query, size_t count, size_t max_distance) const;
+
 private:
     TransportCatalogue& db_;              // RequestHandler agregates TransportCatalogue and MapRenderer
 };
@@ -1,19 +1,204 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+/* Precomputation of all-pairs routes table of weights with scalar key */
+enum class RoutesTableAlgorithm {
+    FLOYD_WARSHALL,         /* blocked Floyd-Warshall per connected component, O(V^3) */
+    PER_SOURCE_DIJKSTRA     /* independent single-source Dijkstra from every vertex, O(V * E log V) */
+};
+
+/* All-pairs routes table packed to 8 bytes per route: float weight key and 32-bit prev edge.
+   Missing route has infinite weight, route without edges has NO_PREV_EDGE.
+   Vertexes are split into connected components and only routes inside components are stored,
+   routes between different components don't exist. Every component has its own block of cells,
+   index in block = local_from * component_size + local_to, local id - index of vertex in its component */
+class PackedRoutesTable {
+public:
+    struct Cell {
+        float weight;
+        uint32_t prev_edge;
+    };
+
+    static constexpr float NO_ROUTE = std::numeric_limits<float>::infinity();
+    static constexpr uint32_t NO_PREV_EDGE = std::numeric_limits<uint32_t>::max();
+
+    /* single component of all vertexes */
+    explicit PackedRoutesTable(size_t vertex_count = 0)
+        : PackedRoutesTable(std::vector<uint32_t>(vertex_count, 0))
+    {
+    }
+
+    /* component_ids - index = vertex id, data = component id */
+    explicit PackedRoutesTable(std::vector<uint32_t>&& component_ids)
+        : component_ids_(std::move(component_ids))
+    {
+        BuildLayout();
+        cells_.assign(block_offsets_.back(), Cell{NO_ROUTE, NO_PREV_EDGE});
+    }
+
+    PackedRoutesTable(std::vector<uint32_t>&& component_ids, std::vector<Cell>&& cells)
+        : component_ids_(std::move(component_ids))
+        , cells_(std::move(cells))
+    {
+        BuildLayout();
+        if (cells_.size() != block_offsets_.back()) {
+            throw std::invalid_argument("Routes table size doesn't match components");
+        }
+    }
+
+    size_t GetVertexCount() const {
+        return component_ids_.size();
+    }
+
+    const std::vector<uint32_t>& GetComponentIds() const {
+        return component_ids_;
+    }
+
+    const std::vector<Cell>& GetCells() const {
+        return cells_;
+    }
+
+    size_t GetComponentCount() const {
+        return component_offsets_.size() - 1;
+    }
+
+    size_t GetComponentSize(size_t component) const {
+        return component_offsets_[component + 1] - component_offsets_[component];
+    }
+
+    /* vertexes of component in order of local id */
+    const VertexId* GetComponentVertexes(size_t component) const {
+        return component_vertexes_.data() + component_offsets_[component];
+    }
+
+    uint32_t GetComponentId(VertexId vertex) const {
+        return component_ids_[vertex];
+    }
+
+    uint32_t GetLocalId(VertexId vertex) const {
+        return local_ids_[vertex];
+    }
+
+    /* O(1) for vertexes of different components */
+    Cell Get(VertexId from, VertexId to) const {
+        if (from >= GetVertexCount() || to >= GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of routes table");
+        }
+        if (component_ids_[from] != component_ids_[to]) {
+            return Cell{NO_ROUTE, NO_PREV_EDGE};
+        }
+        return GetRow(from)[local_ids_[to]];
+    }
+
+    /* routes from vertex inside its component, index = local id of vertex_to */
+    Cell* GetRow(VertexId from) {
+        return cells_.data() + GetRowOffset(from);
+    }
+
+    const Cell* GetRow(VertexId from) const {
+        return cells_.data() + GetRowOffset(from);
+    }
+
+    static bool HasRoute(const Cell& cell) {
+        return cell.weight != NO_ROUTE;
+    }
+
+private:
+    size_t GetRowOffset(VertexId from) const {
+        const uint32_t component = component_ids_[from];
+        return block_offsets_[component] + local_ids_[from] * GetComponentSize(component);
+    }
+
+    /* counting sort of vertexes by component */
+    void BuildLayout() {
+        const size_t vertex_count = component_ids_.size();
+        const size_t component_count = vertex_count == 0
+                                       ? 0
+                                       : *std::max_element(component_ids_.begin(), component_ids_.end()) + 1;
+        component_offsets_.assign(component_count + 1, 0);
+        for (const uint32_t component : component_ids_) {
+            ++component_offsets_[component + 1];
+        }
+        block_offsets_.assign(component_count + 1, 0);
+        for (size_t component = 0; component < component_count; ++component) {
+            const size_t size = component_offsets_[component + 1];
+            block_offsets_[component + 1] = block_offsets_[component] + size * size;
+            component_offsets_[component + 1] += component_offsets_[component];
+        }
+        component_vertexes_.resize(vertex_count);
+        local_ids_.resize(vertex_count);
+        std::vector<size_t> fill(component_offsets_.begin(), component_offsets_.end() - 1);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            const uint32_t component = component_ids_[vertex];
+            local_ids_[vertex] = static_cast<uint32_t>(fill[component] - component_offsets_[component]);
+            component_vertexes_[fill[component]++] = vertex;
+        }
+    }
+
+    std::vector<uint32_t> component_ids_;
+    std::vector<uint32_t> local_ids_;
+    std::vector<size_t> component_offsets_;     /* index = component id, offset in component_vertexes_ */
+    std::vector<VertexId> component_vertexes_;
+    std::vector<size_t> block_offsets_;         /* index = component id, offset of component block in cells_ */
+    std::vector<Cell> cells_;
+};
+
+/* Weakly connected components: no route exists between vertexes of different components.
+   Returns component id of every vertex, components are numbered in order of their first vertex */
+template <typename Weight>
+std::vector<uint32_t> FindConnectedComponents(const CsrGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<VertexId> parents(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        parents[vertex] = vertex;
+    }
+    auto find_root = [&parents](VertexId vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];     // path halving
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        const VertexId from_root = find_root(edge.from);
+        const VertexId to_root = find_root(edge.to);
+        if (from_root != to_root) {
+            parents[std::max(from_root, to_root)] = std::min(from_root, to_root);
+        }
+    }
+
+    // roots are the least vertexes of components
+    std::vector<uint32_t> component_ids(vertex_count);
+    uint32_t component_count = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find_root(vertex);
+        component_ids[vertex] = (root == vertex) ? component_count++ : component_ids[root];
+    }
+    return component_ids;
+}
+
 template <typename Weight>
 class Router;
 
@@ -26,9 +211,11 @@ struct RouterInternalState {
 template <typename Weight>
 class Router {
 public:
-    using Graph = DirectedWeightedGraph<Weight>;
+    using Graph = CsrGraph<Weight>;
 
-    explicit Router(const Graph& graph);
+    /* thread_count - threads for routes precomputation, 0 - hardware concurrency */
+    explicit Router(const Graph& graph, size_t thread_count = 1,
+                    RoutesTableAlgorithm algorithm = RoutesTableAlgorithm::FLOYD_WARSHALL);
 
     struct RouteInfo {
         Weight weight;
@@ -41,12 +228,31 @@ public:
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    /* weights with scalar key are stored in packed table, route weight is summed along edges on demand */
+    using RoutesInternalData = std::conditional_t<WeightTraits<Weight>::HAS_SCALAR_KEY,
+                                                  PackedRoutesTable,
+                                                  std::vector<std::vector<std::optional<RouteInternalData>>>>;
 
     const RouterInternalState<Weight> ExportInternalState() const;
     void ExternalInitialization(RoutesInternalData&& routes_internal_data);
 
+    /* Repair packed routes table after the graph referenced by router has been changed.
+       edge_id_map - index = old edge id, data = new edge id or min_plus::NO_EDGE if edge was removed;
+       added_edges - new ids of edges which were added.
+       Rows whose routes tree lost an edge or may be improved by an added edge are recomputed
+       by Dijkstra, prev edges of other rows are renumbered. Vertex count must not change.
+       If connected components have changed, the table is built again with algorithm. */
+    void UpdateRoutes(const std::vector<EdgeId>& edge_id_map, const std::vector<EdgeId>& added_edges,
+                      size_t thread_count = 1,
+                      RoutesTableAlgorithm algorithm = RoutesTableAlgorithm::FLOYD_WARSHALL);
+
 private:
+    /* Packed table of routes inside connected components */
+    void BuildRoutesTable(size_t thread_count, RoutesTableAlgorithm algorithm);
+    bool IsRowAffected(VertexId vertex_from, const std::vector<EdgeId>& edge_id_map,
+                       const std::vector<EdgeId>& added_edges) const;
+    void ComputeRow(VertexId vertex_from);
+
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
@@ -74,55 +280,206 @@ private:
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    /* Relax routes of tile (tile_from, tile_to) through vertices of tile_through */
+    void RelaxTileThroughTile(size_t vertex_count, size_t tile_from, size_t tile_to, size_t tile_through) {
+        const VertexId from_end = std::min(vertex_count, (tile_from + 1) * TILE_SIZE);
+        const VertexId to_end = std::min(vertex_count, (tile_to + 1) * TILE_SIZE);
+        const VertexId through_end = std::min(vertex_count, (tile_through + 1) * TILE_SIZE);
+        for (VertexId vertex_through = tile_through * TILE_SIZE; vertex_through < through_end; ++vertex_through) {
+            for (VertexId vertex_from = tile_from * TILE_SIZE; vertex_from < from_end; ++vertex_from) {
+                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
+                    for (VertexId vertex_to = tile_to * TILE_SIZE; vertex_to < to_end; ++vertex_to) {
+                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
+                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+                        }
                     }
                 }
             }
         }
     }
 
+    /* Blocked Floyd-Warshall. For every diagonal tile: relax the tile itself,
+       then its row and column tiles in parallel, then all remaining tiles in parallel */
+    void RelaxRoutesInternalData(size_t vertex_count, size_t thread_count) {
+        parallel::ThreadPool thread_pool(thread_count);
+        const size_t tile_count = (vertex_count + TILE_SIZE - 1) / TILE_SIZE;
+        for (size_t tile_through = 0; tile_through < tile_count; ++tile_through) {
+            RelaxTileThroughTile(vertex_count, tile_through, tile_through, tile_through);
+
+            // index < tile_count - row tiles, others - column tiles
+            thread_pool.ParallelFor(2 * tile_count, [&](size_t index) {
+                const size_t tile = index % tile_count;
+                if (tile == tile_through) return;
+                if (index < tile_count) {
+                    RelaxTileThroughTile(vertex_count, tile_through, tile, tile_through);
+                } else {
+                    RelaxTileThroughTile(vertex_count, tile, tile_through, tile_through);
+                }
+            });
+
+            thread_pool.ParallelFor(tile_count * tile_count, [&](size_t index) {
+                const size_t tile_from = index / tile_count;
+                const size_t tile_to = index % tile_count;
+                if (tile_from == tile_through || tile_to == tile_through) return;
+                RelaxTileThroughTile(vertex_count, tile_from, tile_to, tile_through);
+            });
+        }
+    }
+
+    /* Routes table of component in structure of arrays layout for vectorized precomputation.
+       index = local_from * vertex_count + local_to */
+    struct RoutesKeyData {
+        size_t vertex_count;
+        std::vector<double> weights;        /* weight keys, +infinity if no route */
+        std::vector<EdgeId> prev_edges;     /* min_plus::NO_EDGE if no prev edge */
+    };
+
+    RoutesKeyData InitializeRoutesKeyData(size_t component) const {
+        using Traits = WeightTraits<Weight>;
+        const PackedRoutesTable& table = routes_internal_data_;
+        const size_t vertex_count = table.GetComponentSize(component);
+        const VertexId* vertexes = table.GetComponentVertexes(component);
+        RoutesKeyData data{vertex_count,
+                           std::vector<double>(vertex_count * vertex_count, std::numeric_limits<double>::infinity()),
+                           std::vector<EdgeId>(vertex_count * vertex_count, min_plus::NO_EDGE)};
+        for (VertexId local_id = 0; local_id < vertex_count; ++local_id) {
+            data.weights[local_id * vertex_count + local_id] = Traits::GetKey(ZERO_WEIGHT);
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertexes[local_id])) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const size_t index = local_id * vertex_count + table.GetLocalId(edge.to);
+                const double key = Traits::GetKey(edge.weight);
+                if (key < data.weights[index]) {
+                    data.weights[index] = key;
+                    data.prev_edges[index] = edge_id;
+                }
+            }
+        }
+        return data;
+    }
+
+    /* Same relaxation order as RelaxTileThroughTile, rows are relaxed by min-plus kernel */
+    static void RelaxKeyTileThroughTile(RoutesKeyData& data, size_t tile_from, size_t tile_to, size_t tile_through) {
+        const size_t vertex_count = data.vertex_count;
+        const VertexId from_end = std::min(vertex_count, (tile_from + 1) * TILE_SIZE);
+        const VertexId to_begin = tile_to * TILE_SIZE;
+        const VertexId to_end = std::min(vertex_count, (tile_to + 1) * TILE_SIZE);
+        const VertexId through_end = std::min(vertex_count, (tile_through + 1) * TILE_SIZE);
+        for (VertexId vertex_through = tile_through * TILE_SIZE; vertex_through < through_end; ++vertex_through) {
+            const size_t through_row = vertex_through * vertex_count;
+            for (VertexId vertex_from = tile_from * TILE_SIZE; vertex_from < from_end; ++vertex_from) {
+                const size_t from_row = vertex_from * vertex_count;
+                const double through_weight = data.weights[from_row + vertex_through];
+                if (through_weight == std::numeric_limits<double>::infinity()) continue;
+                min_plus::RelaxRow(through_weight, data.prev_edges[from_row + vertex_through],
+                                   data.weights.data() + through_row + to_begin,
+                                   data.prev_edges.data() + through_row + to_begin,
+                                   data.weights.data() + from_row + to_begin,
+                                   data.prev_edges.data() + from_row + to_begin,
+                                   to_end - to_begin);
+            }
+        }
+    }
+
+    static void RelaxRoutesKeyData(RoutesKeyData& data, parallel::ThreadPool& thread_pool) {
+        const size_t tile_count = (data.vertex_count + TILE_SIZE - 1) / TILE_SIZE;
+        for (size_t tile_through = 0; tile_through < tile_count; ++tile_through) {
+            RelaxKeyTileThroughTile(data, tile_through, tile_through, tile_through);
+
+            thread_pool.ParallelFor(2 * tile_count, [&](size_t index) {
+                const size_t tile = index % tile_count;
+                if (tile == tile_through) return;
+                if (index < tile_count) {
+                    RelaxKeyTileThroughTile(data, tile_through, tile, tile_through);
+                } else {
+                    RelaxKeyTileThroughTile(data, tile, tile_through, tile_through);
+                }
+            });
+
+            thread_pool.ParallelFor(tile_count * tile_count, [&](size_t index) {
+                const size_t tile_from = index / tile_count;
+                const size_t tile_to = index % tile_count;
+                if (tile_from == tile_through || tile_to == tile_through) return;
+                RelaxKeyTileThroughTile(data, tile_from, tile_to, tile_through);
+            });
+        }
+    }
+
+    /* Convert key data to component block of packed routes table */
+    void PackRoutesKeyData(const RoutesKeyData& data, size_t component) {
+        if (data.vertex_count == 0) return;
+        // rows of component are consecutive, block starts with row of its first vertex
+        PackedRoutesTable::Cell* cells =
+                routes_internal_data_.GetRow(routes_internal_data_.GetComponentVertexes(component)[0]);
+        for (size_t index = 0; index < data.weights.size(); ++index) {
+            const EdgeId prev_edge = data.prev_edges[index];
+            cells[index] = {static_cast<float>(data.weights[index]),
+                            prev_edge == min_plus::NO_EDGE ? PackedRoutesTable::NO_PREV_EDGE
+                                                           : static_cast<uint32_t>(prev_edge)};
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
+    static constexpr size_t TILE_SIZE = 32;     /* tile side, vertices */
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, size_t thread_count, RoutesTableAlgorithm algorithm)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
 {
-    InitializeRoutesInternalData(graph);
-
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    if constexpr (WeightTraits<Weight>::HAS_SCALAR_KEY) {
+        BuildRoutesTable(thread_count, algorithm);
+    } else {
+        routes_internal_data_.assign(graph.GetVertexCount(),
+                                     std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()));
+        InitializeRoutesInternalData(graph);
+        RelaxRoutesInternalData(graph.GetVertexCount(), thread_count);
     }
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
-        return std::nullopt;
-    }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-    {
-        edges.push_back(*edge_id);
-    }
-    std::reverse(edges.begin(), edges.end());
+    if constexpr (WeightTraits<Weight>::HAS_SCALAR_KEY) {
+        const PackedRoutesTable::Cell cell = routes_internal_data_.Get(from, to);
+        if (!PackedRoutesTable::HasRoute(cell)) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (uint32_t edge_id = cell.prev_edge;
+             edge_id != PackedRoutesTable::NO_PREV_EDGE;
+             edge_id = routes_internal_data_.Get(from, graph_.GetEdge(edge_id).from).prev_edge)
+        {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
 
-    return RouteInfo{weight, std::move(edges)};
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight = weight + graph_.GetEdge(edge_id).weight;
+        }
+        return RouteInfo{weight, std::move(edges)};
+    } else {
+        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+        if (!route_internal_data) {
+            return std::nullopt;
+        }
+        const Weight weight = route_internal_data->weight;
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
+             edge_id;
+             edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{weight, std::move(edges)};
+    }
 }
 
 template <typename Weight>
@@ -136,4 +493,160 @@ inline void Router<Weight>::ExternalInitialization
     std::swap(routes_internal_data_, routes_internal_data);
 }
 
+/* Floyd-Warshall: components up to a tile are relaxed in parallel one per thread,
+   larger ones one by one with parallel blocked Floyd-Warshall.
+   Per-source Dijkstra: every row is computed by its own search, rows are taken by threads
+   from shared counter, so threads which got short searches take more rows */
+template <typename Weight>
+void Router<Weight>::BuildRoutesTable(size_t thread_count, RoutesTableAlgorithm algorithm) {
+    if (graph_.GetEdgeCount() >= PackedRoutesTable::NO_PREV_EDGE) {
+        throw std::length_error("Too many edges for packed routes table");
+    }
+    routes_internal_data_ = PackedRoutesTable(FindConnectedComponents(graph_));
+
+    parallel::ThreadPool thread_pool(thread_count);
+    if (algorithm == RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA) {
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        // every search writes only its own row
+        thread_pool.ParallelFor(routes_internal_data_.GetVertexCount(), [&](size_t vertex_from) {
+            ComputeRow(vertex_from);
+        });
+        return;
+    }
+
+    const size_t component_count = routes_internal_data_.GetComponentCount();
+    std::vector<size_t> small_components;
+    for (size_t component = 0; component < component_count; ++component) {
+        if (routes_internal_data_.GetComponentSize(component) <= TILE_SIZE) {
+            small_components.push_back(component);
+            continue;
+        }
+        RoutesKeyData routes_key_data = InitializeRoutesKeyData(component);
+        RelaxRoutesKeyData(routes_key_data, thread_pool);
+        PackRoutesKeyData(routes_key_data, component);
+    }
+    thread_pool.ParallelFor(small_components.size(), [&](size_t index) {
+        RoutesKeyData routes_key_data = InitializeRoutesKeyData(small_components[index]);
+        RelaxKeyTileThroughTile(routes_key_data, 0, 0, 0);
+        PackRoutesKeyData(routes_key_data, small_components[index]);
+    });
+}
+
+template <typename Weight>
+bool Router<Weight>::IsRowAffected(VertexId vertex_from, const std::vector<EdgeId>& edge_id_map,
+                                   const std::vector<EdgeId>& added_edges) const {
+    const PackedRoutesTable& table = routes_internal_data_;
+    const uint32_t component = table.GetComponentId(vertex_from);
+    const size_t vertex_count = table.GetComponentSize(component);
+    const PackedRoutesTable::Cell* row = table.GetRow(vertex_from);
+
+    // routes tree lost an edge
+    for (VertexId local_to = 0; local_to < vertex_count; ++local_to) {
+        const uint32_t prev_edge = row[local_to].prev_edge;
+        if (prev_edge != PackedRoutesTable::NO_PREV_EDGE && edge_id_map[prev_edge] == min_plus::NO_EDGE) {
+            return true;
+        }
+    }
+
+    // added edge inside component gives shorter route. Cells keep rounded float weights, so a route
+    // shorter by less than their rounding error is counted as shorter too
+    for (const EdgeId edge_id : added_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (table.GetComponentId(edge.from) != component) continue;
+        const PackedRoutesTable::Cell& route_from = row[table.GetLocalId(edge.from)];
+        const PackedRoutesTable::Cell& route_to = row[table.GetLocalId(edge.to)];
+        if (!PackedRoutesTable::HasRoute(route_from)) continue;
+        const double rounding_error = (double{route_from.weight} + double{route_to.weight})
+                                      * std::numeric_limits<float>::epsilon();
+        if (route_from.weight + WeightTraits<Weight>::GetKey(edge.weight) < route_to.weight + rounding_error) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Single-source Dijkstra over route keys inside component of source, labels are indexed by local ids */
+template <typename Weight>
+void Router<Weight>::ComputeRow(VertexId vertex_from) {
+    const PackedRoutesTable& table = routes_internal_data_;
+    const size_t vertex_count = table.GetComponentSize(table.GetComponentId(vertex_from));
+    std::vector<double> keys(vertex_count, std::numeric_limits<double>::infinity());
+    std::vector<EdgeId> prev_edges(vertex_count, min_plus::NO_EDGE);
+    keys[table.GetLocalId(vertex_from)] = 0;
+
+    using QueueItem = std::pair<double, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({0, vertex_from});
+    while (!queue.empty()) {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (keys[table.GetLocalId(vertex)] < key) continue;   // outdated queue item
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const uint32_t local_to = table.GetLocalId(edge.to);
+            const double candidate = key + WeightTraits<Weight>::GetKey(edge.weight);
+            if (candidate < keys[local_to]) {
+                keys[local_to] = candidate;
+                prev_edges[local_to] = edge_id;
+                queue.push({candidate, edge.to});
+            }
+        }
+    }
+
+    PackedRoutesTable::Cell* row = routes_internal_data_.GetRow(vertex_from);
+    for (VertexId local_to = 0; local_to < vertex_count; ++local_to) {
+        row[local_to] = {static_cast<float>(keys[local_to]),
+                         prev_edges[local_to] == min_plus::NO_EDGE ? PackedRoutesTable::NO_PREV_EDGE
+                                                                   : static_cast<uint32_t>(prev_edges[local_to])};
+    }
+}
+
+template <typename Weight>
+void Router<Weight>::UpdateRoutes(const std::vector<EdgeId>& edge_id_map, const std::vector<EdgeId>& added_edges,
+                                  size_t thread_count, RoutesTableAlgorithm algorithm) {
+    static_assert(WeightTraits<Weight>::HAS_SCALAR_KEY, "Routes update needs weights with scalar key");
+
+    const size_t vertex_count = routes_internal_data_.GetVertexCount();
+    if (graph_.GetVertexCount() != vertex_count) {
+        throw std::invalid_argument("Vertex count of graph has been changed");
+    }
+    if (graph_.GetEdgeCount() >= PackedRoutesTable::NO_PREV_EDGE) {
+        throw std::length_error("Too many edges for packed routes table");
+    }
+    // merged or split components change table layout
+    if (FindConnectedComponents(graph_) != routes_internal_data_.GetComponentIds()) {
+        BuildRoutesTable(thread_count, algorithm);
+        return;
+    }
+
+    parallel::ThreadPool thread_pool(thread_count);
+
+    // find affected rows before any row is changed
+    std::vector<char> is_affected(vertex_count, false);
+    thread_pool.ParallelFor(vertex_count, [&](size_t vertex_from) {
+        is_affected[vertex_from] = IsRowAffected(vertex_from, edge_id_map, added_edges);
+    });
+
+    thread_pool.ParallelFor(vertex_count, [&](size_t vertex_from) {
+        if (is_affected[vertex_from]) {
+            ComputeRow(vertex_from);
+            return;
+        }
+        PackedRoutesTable::Cell* row = routes_internal_data_.GetRow(vertex_from);
+        const size_t component_size =
+                routes_internal_data_.GetComponentSize(routes_internal_data_.GetComponentId(vertex_from));
+        for (VertexId local_to = 0; local_to < component_size; ++local_to) {
+            uint32_t& prev_edge = row[local_to].prev_edge;
+            if (prev_edge != PackedRoutesTable::NO_PREV_EDGE) {
+                prev_edge = static_cast<uint32_t>(edge_id_map[prev_edge]);
+            }
+        }
+    });
+}
+
 }  // namespace graph
\ No newline at end of file
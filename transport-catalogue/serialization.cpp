@@ -1,6 +1,7 @@
 #include "serialization.h"
 
 #include <fstream>
+#include <stdexcept>
 #include <deque>
 
 namespace transport_catalogue {
@@ -17,6 +18,17 @@ void Serialization::ClearContainers() {
     serialized_catalogue_.Clear();
 }
 
+/* Serialize Names */
+
+void Serialization::SaveNames(const TransportCatalogue& transport_catalogue) {
+    const domain::StringPool& names = transport_catalogue.GetNames();
+    tc_proto::Names* p_names = serialized_catalogue_.mutable_names();
+    p_names->set_data(names.MakeBlob());
+    for (const uint32_t offset : names.MakeOffsets()) {
+        p_names->add_offsets(offset);
+    }
+}
+
 /* Serialize Stops */
 tc_proto::GeoCoordinates MakeProtoGeoCoordinates(double latitude, double longitude) {
     tc_proto::GeoCoordinates p_coordinates;
@@ -25,20 +37,20 @@ tc_proto::GeoCoordinates MakeProtoGeoCoordinates(double latitude, double longitu
     return p_coordinates;
 }
 
-tc_proto::Stop MakeProtoStop(const domain::Stop& stop) {
+tc_proto::Stop MakeProtoStop(const domain::Stop& stop, const domain::StringPool& names) {
     tc_proto::Stop p_stop;
     p_stop.set_id(stop.id);
-    p_stop.set_name(stop.name);
+    p_stop.set_name(*names.Find(stop.name));
     *p_stop.mutable_coordinates() = 
                 MakeProtoGeoCoordinates(stop.coordinates.lat, stop.coordinates.lng);
     return p_stop;
 }
 
 void Serialization::SaveStops(const TransportCatalogue& transport_catalogue) {
-    const auto stops = transport_catalogue.GetAllStops();
+    const auto& stops = transport_catalogue.GetAllStops();
     for (const auto& stop : stops) {
         tc_proto::Stop* new_stop = serialized_catalogue_.add_stops();
-        *new_stop = MakeProtoStop(stop);
+        *new_stop = MakeProtoStop(stop, transport_catalogue.GetNames());
     }
 }
 
@@ -59,11 +71,11 @@ tc_proto::BusType MakeProtoBusType(const domain::BusType bus_type) {
     return p_bus_type;
 }
 
-tc_proto::Bus MakeProtoBus(const domain::Bus& bus) {
+tc_proto::Bus MakeProtoBus(const domain::Bus& bus, const domain::StringPool& names) {
     tc_proto::Bus p_bus;
     p_bus.set_id(bus.id);
     p_bus.set_bus_type(MakeProtoBusType(bus.type));
-    p_bus.set_bus_name(bus.name);
+    p_bus.set_bus_name(*names.Find(bus.name));
     for (const domain::Stop* stop : bus.stops) {
         p_bus.add_stop_ids(stop->id);
     }
@@ -71,9 +83,9 @@ tc_proto::Bus MakeProtoBus(const domain::Bus& bus) {
 }
 
 void Serialization::SaveBuses(const TransportCatalogue& transport_catalogue) {
-    auto buses = transport_catalogue.GetAllBuses();
+    const auto& buses = transport_catalogue.GetAllBuses();
     for (const auto& bus : buses) {
-        *serialized_catalogue_.add_buses() = MakeProtoBus(bus);
+        *serialized_catalogue_.add_buses() = MakeProtoBus(bus, transport_catalogue.GetNames());
     }
 }
 
@@ -89,15 +101,71 @@ MakeProtoDistances(uint32_t stop_id_from, uint32_t stop_id_to, int distance) {
 }
 
 void Serialization::SaveDistances(const TransportCatalogue& transport_catalogue) {
-    const auto& distances = transport_catalogue.GetDistances();
-    for (const auto& [stops, distance] : distances) {
-        size_t stop_id_from = stops.first->id;
-        size_t stop_id_to = stops.second->id;
+    for (const auto& [stop_id_from, stop_id_to, distance] : transport_catalogue.GetDistances().GetSetDistances()) {
         *serialized_catalogue_.add_distances() = 
                     MakeProtoDistances(stop_id_from, stop_id_to, distance);
     }
 }
 
+/* Serialize Bus infos */
+
+void Serialization::SaveBusInfos(const TransportCatalogue& transport_catalogue) {
+    const auto& bus_infos = transport_catalogue.GetBusInfos();
+    if (bus_infos.empty()) return;
+
+    tc_proto::BusInfos* p_bus_infos = serialized_catalogue_.mutable_bus_infos();
+    for (const auto& info : bus_infos) {
+        p_bus_infos->add_stops_count(info.stops_count);
+        p_bus_infos->add_unique_stops_count(info.unique_stops_count);
+        p_bus_infos->add_geo_route_length(info.geo_route_length);
+        p_bus_infos->add_route_length(info.route_length);
+    }
+}
+
+/* Serialize Spatial index */
+
+void Serialization::SaveSpatialIndex(const TransportCatalogue& transport_catalogue) {
+    const domain::SpatialIndex& spatial_index = transport_catalogue.GetSpatialIndex();
+    if (!spatial_index.IsBuilt()) return;
+
+    const domain::SpatialIndex::Data& data = spatial_index.GetData();
+    tc_proto::SpatialIndex* p_spatial_index = serialized_catalogue_.mutable_spatial_index();
+    *p_spatial_index->mutable_min() = MakeProtoGeoCoordinates(data.min.lat, data.min.lng);
+    p_spatial_index->set_cell_lat(data.cell_lat);
+    p_spatial_index->set_cell_lng(data.cell_lng);
+    p_spatial_index->set_rows(data.rows);
+    p_spatial_index->set_cols(data.cols);
+    for (const uint32_t offset : data.cell_offsets) {
+        p_spatial_index->add_cell_offsets(offset);
+    }
+    for (const auto& point : data.points) {
+        p_spatial_index->add_stop_ids(point.id);
+    }
+}
+
+/* Serialize Name index */
+
+tc_proto::NameKind MakeProtoNameKind(const domain::NameKind name_kind) {
+    return name_kind == domain::NameKind::BUS ? tc_proto::NameKind::BUS_NAME : tc_proto::NameKind::STOP_NAME;
+}
+
+void Serialization::SaveNameIndex(const TransportCatalogue& transport_catalogue) {
+    const domain::NameIndex& name_index = transport_catalogue.GetNameIndex();
+    if (!name_index.IsBuilt()) return;
+
+    const domain::NameIndex::Data& data = name_index.GetData();
+    tc_proto::NameIndex* p_name_index = serialized_catalogue_.mutable_name_index();
+    p_name_index->set_labels(data.labels);
+    *p_name_index->mutable_subtree_ends() = {data.subtree_ends.begin(), data.subtree_ends.end()};
+    *p_name_index->mutable_max_weights() = {data.max_weights.begin(), data.max_weights.end()};
+    *p_name_index->mutable_entry_offsets() = {data.entry_offsets.begin(), data.entry_offsets.end()};
+    for (const auto& entry : data.entries) {
+        p_name_index->add_entry_names(entry.name);
+        p_name_index->add_entry_kinds(MakeProtoNameKind(entry.kind));
+        p_name_index->add_entry_weights(entry.weight);
+    }
+}
+
 /* Serialize Renderer Settings */
 
 svg_proto::Point MakeProtoPoint(const svg::Point& point) {
@@ -159,58 +227,80 @@ void Serialization::SaveRendererSettings
 
 /* Serialize Transport Router settings */
 
-void Serialization::SaveTransportRouterSettings(const TransportRouter::Settings& router_settings) {
-   
-    tr_proto::RouterSettings* p_settings = 
-                    serialized_catalogue_.mutable_router_settings();
-    p_settings->set_bus_velocity(router_settings.bus_velocity);
-    p_settings->set_bus_wait_time(router_settings.bus_wait_time);
+tr_proto::RouterType MakeProtoRouterType(const transport_router::RouterType router_type) {
+    tr_proto::RouterType p_router_type;
+    switch (router_type) {
+        case transport_router::RouterType::DIJKSTRA :
+            p_router_type = tr_proto::RouterType::DIJKSTRA;
+            break;
+        case transport_router::RouterType::CONTRACTION_HIERARCHY :
+            p_router_type = tr_proto::RouterType::CONTRACTION_HIERARCHY;
+            break;
+        case transport_router::RouterType::RAPTOR :
+            p_router_type = tr_proto::RouterType::RAPTOR;
+            break;
+        case transport_router::RouterType::A_STAR :
+            p_router_type = tr_proto::RouterType::A_STAR;
+            break;
+        case transport_router::RouterType::HUB_LABELS :
+            p_router_type = tr_proto::RouterType::HUB_LABELS;
+            break;
+        case transport_router::RouterType::LAZY :
+            p_router_type = tr_proto::RouterType::LAZY;
+            break;
+        default :
+            p_router_type = tr_proto::RouterType::ALL_PAIRS;
+    }
+    return p_router_type;
 }
 
-/* Serialize Graph */
-
-g_proto::EdgeWeight MakeProtoEdgeWeight(const graph::Edge<transport_router::EdgeWeight>& edge) {
-    g_proto::EdgeWeight p_edge_weight;
-    p_edge_weight.set_total_time(edge.weight.total_time);
-    p_edge_weight.set_stops_number(edge.weight.stops_number);
-    p_edge_weight.set_bus_id(edge.weight.bus_id);
-    return p_edge_weight;
+tr_proto::GraphModel MakeProtoGraphModel(const transport_router::GraphModel graph_model) {
+    return graph_model == transport_router::GraphModel::TRANSFER ? tr_proto::GraphModel::TRANSFER
+                                                                 : tr_proto::GraphModel::DIRECT;
 }
 
-g_proto::Edge MakeProtoEdge(const graph::Edge<transport_router::EdgeWeight>& edge) {
-    g_proto::Edge p_edge;
-    p_edge.set_vertex_id_from(edge.from);
-    p_edge.set_vertex_id_to(edge.to);
-    *p_edge.mutable_weight() = MakeProtoEdgeWeight(edge);
-    return p_edge;
+tr_proto::RoutesTableAlgorithm MakeProtoRoutesTableAlgorithm(const graph::RoutesTableAlgorithm algorithm) {
+    return algorithm == graph::RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA
+                        ? tr_proto::RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA
+                        : tr_proto::RoutesTableAlgorithm::FLOYD_WARSHALL;
 }
 
-g_proto::IncidenceList MakeProtoIncedenceList
-            (const ranges::Range<std::vector<graph::EdgeId>::const_iterator> incident_edges) {
-    
-    g_proto::IncidenceList p_incident_list{};
-    for (const auto& edge : incident_edges) {
-        p_incident_list.add_edge_id(edge);
+void Serialization::SaveTransportRouterSettings(const TransportRouter::Settings& router_settings) {
+   
+    tr_proto::RouterSettings* p_settings = 
+                    serialized_catalogue_.mutable_router_settings();
+    p_settings->set_bus_velocity(router_settings.bus_velocity);
+    p_settings->set_bus_wait_time(router_settings.bus_wait_time);
+    p_settings->set_router_type(MakeProtoRouterType(router_settings.router_type));
+    p_settings->set_route_cache_size(router_settings.route_cache_size);
+    p_settings->set_graph_model(MakeProtoGraphModel(router_settings.graph_model));
+    p_settings->set_landmark_count(router_settings.landmark_count);
+    p_settings->set_route_memory_limit(router_settings.route_memory_limit);
+    p_settings->set_routes_table_algorithm(MakeProtoRoutesTableAlgorithm(router_settings.routes_table_algorithm));
+    if (router_settings.max_transfers) {
+        p_settings->set_max_transfers(*router_settings.max_transfers);
     }
-    return p_incident_list;
 }
 
-void Serialization::SaveGraph(const std::optional<TransportRouter::Graph>& graph) {
-    if (!graph) return;
+/* Serialize Graph */
 
+void Serialization::SaveGraph(const TransportRouter::Graph& graph) {
     g_proto::Graph* p_graph = serialized_catalogue_.mutable_graph();
 
-    // fill edges
-    const size_t edges_count = graph->GetEdgeCount();
-    for (graph::VertexId edge_id = 0; edge_id < edges_count; ++edge_id) {
-        *p_graph->add_edges() = MakeProtoEdge(graph->GetEdge(edge_id));
-    }
-
-    // fill IncidenceList - Maybe NOT NEEDED !!!
-    const size_t vertex_count = graph->GetVertexCount();
-    for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-        *p_graph->add_incedence_lists() = 
-                    MakeProtoIncedenceList(graph->GetIncidentEdges(vertex));
+    graph::CsrGraphInternalState internal_data = graph.ExportInternalState();
+    p_graph->mutable_offsets()->Add(internal_data.offsets.begin(), internal_data.offsets.end());
+
+    // edges as parallel arrays, "from" vertex is defined by offsets
+    const size_t edges_count = internal_data.edges.size();
+    p_graph->mutable_vertex_id_to()->Reserve(edges_count);
+    p_graph->mutable_total_time()->Reserve(edges_count);
+    p_graph->mutable_stops_number()->Reserve(edges_count);
+    p_graph->mutable_bus_id()->Reserve(edges_count);
+    for (const auto& edge : internal_data.edges) {
+        p_graph->add_vertex_id_to(edge.to);
+        p_graph->add_total_time(edge.weight.total_time);
+        p_graph->add_stops_number(edge.weight.stops_number);
+        p_graph->add_bus_id(edge.weight.bus_id);
     }
 }
 
@@ -224,33 +314,91 @@ tr_proto::Weight MakeProtoWeight(const transport_router::EdgeWeight& weight) {
     return p_weight;
 }
 
-tr_proto::RouteData MakeProtoRouteData
-            (const optional<TransportRouter::Router::RouteInternalData>& opt_route_data) {
-    tr_proto::RouteData p_route_data;
-    *p_route_data.mutable_weight() = MakeProtoWeight(opt_route_data->weight);
-    if (opt_route_data->prev_edge.has_value()) {
-        p_route_data.set_prev_edge(*(opt_route_data->prev_edge));
-    }
-    return p_route_data;
-}
+void Serialization::SaveRouter(const TransportRouter::Router* router) {
+    if (!router) return;    // router type without routes table
 
-void Serialization::SaveRouter(const TransportRouter::Router& router) {
     tr_proto::RoutesInternalData* 
     p_routes_internal_data = serialized_catalogue_.mutable_routes_internal_data();
 
-    graph::RouterInternalState internal_data = router.ExportInternalState();
-    for (const auto& vector_of_data : internal_data.routes_internal_data) {
-        auto new_vector = p_routes_internal_data->add_routes_internal_data();
-        for (const auto& opt_route_data : vector_of_data) {
-            auto new_vector_opt_route_data = new_vector->add_optional_route_data();
-            if (opt_route_data.has_value()) {
-                *new_vector_opt_route_data->mutable_route_data() = 
-                                            MakeProtoRouteData(opt_route_data);
-            }
-        }
+    graph::RouterInternalState internal_data = router->ExportInternalState();
+    const auto& cells = internal_data.routes_internal_data.GetCells();
+    p_routes_internal_data->set_vertex_count(internal_data.routes_internal_data.GetVertexCount());
+    const auto& component_ids = internal_data.routes_internal_data.GetComponentIds();
+    p_routes_internal_data->mutable_component_ids()->Add(component_ids.begin(), component_ids.end());
+    p_routes_internal_data->mutable_weights()->Reserve(cells.size());
+    p_routes_internal_data->mutable_prev_edges()->Reserve(cells.size());
+    for (const auto& cell : cells) {
+        p_routes_internal_data->add_weights(cell.weight);
+        p_routes_internal_data->add_prev_edges(cell.prev_edge);
+    }
+}
+
+/* Serialize Contraction Hierarchy */
+
+tr_proto::Shortcut MakeProtoShortcut(const graph::Shortcut<transport_router::EdgeWeight>& shortcut) {
+    tr_proto::Shortcut p_shortcut;
+    p_shortcut.set_vertex_id_from(shortcut.from);
+    p_shortcut.set_vertex_id_to(shortcut.to);
+    *p_shortcut.mutable_weight() = MakeProtoWeight(shortcut.weight);
+    p_shortcut.set_first_edge(shortcut.first_edge);
+    p_shortcut.set_second_edge(shortcut.second_edge);
+    return p_shortcut;
+}
+
+void Serialization::SaveContractionHierarchy
+            (const TransportRouter::ContractionHierarchy* contraction_hierarchy) {
+    if (!contraction_hierarchy) return;
+
+    tr_proto::ContractionHierarchy* 
+    p_contraction_hierarchy = serialized_catalogue_.mutable_contraction_hierarchy();
+
+    graph::ContractionHierarchyInternalState internal_data = contraction_hierarchy->ExportInternalState();
+    for (const size_t rank : internal_data.vertex_ranks) {
+        p_contraction_hierarchy->add_vertex_ranks(rank);
+    }
+    for (const auto& shortcut : internal_data.shortcuts) {
+        *p_contraction_hierarchy->add_shortcuts() = MakeProtoShortcut(shortcut);
     }
 }
 
+/* Serialize A* Landmarks */
+
+void Serialization::SaveLandmarks(const TransportRouter::AStarRouter* a_star_router) {
+    if (!a_star_router) return;
+
+    tr_proto::Landmarks* p_landmarks = serialized_catalogue_.mutable_landmarks();
+
+    graph::AStarInternalState internal_data = a_star_router->ExportInternalState();
+    p_landmarks->mutable_vertex_ids()->Add(internal_data.landmarks.begin(), internal_data.landmarks.end());
+    p_landmarks->mutable_from_landmarks()->Add(internal_data.from_landmarks.begin(),
+                                               internal_data.from_landmarks.end());
+    p_landmarks->mutable_to_landmarks()->Add(internal_data.to_landmarks.begin(),
+                                             internal_data.to_landmarks.end());
+}
+
+/* Serialize Hub Labels */
+
+tr_proto::HubLabelsData MakeProtoHubLabelsData(const graph::HubLabelsData& labels) {
+    tr_proto::HubLabelsData p_labels;
+    p_labels.mutable_offsets()->Add(labels.offsets.begin(), labels.offsets.end());
+    p_labels.mutable_hubs()->Add(labels.hubs.begin(), labels.hubs.end());
+    p_labels.mutable_keys()->Add(labels.keys.begin(), labels.keys.end());
+    p_labels.mutable_edges()->Add(labels.edges.begin(), labels.edges.end());
+    return p_labels;
+}
+
+void Serialization::SaveHubLabels(const TransportRouter::HubLabels* hub_labels) {
+    if (!hub_labels) return;
+
+    tr_proto::HubLabels* p_hub_labels = serialized_catalogue_.mutable_hub_labels();
+
+    graph::HubLabelsInternalState internal_data = hub_labels->ExportInternalState();
+    p_hub_labels->mutable_hub_vertexes()->Add(internal_data.hub_vertexes.begin(),
+                                              internal_data.hub_vertexes.end());
+    *p_hub_labels->mutable_forward_labels() = MakeProtoHubLabelsData(internal_data.forward_labels);
+    *p_hub_labels->mutable_backward_labels() = MakeProtoHubLabelsData(internal_data.backward_labels);
+}
+
 bool Serialization::SerializeTransportCatalogue
                 (const TransportCatalogue& transport_catalogue,
                  TransportRouter& transport_router, 
@@ -260,9 +408,13 @@ bool Serialization::SerializeTransportCatalogue
         return false;   // error opening out file
     }
    
+    SaveNames(transport_catalogue);
     SaveStops(transport_catalogue);
     SaveBuses(transport_catalogue);
     SaveDistances(transport_catalogue);
+    SaveBusInfos(transport_catalogue);
+    SaveSpatialIndex(transport_catalogue);
+    SaveNameIndex(transport_catalogue);
 
     if (renderer_settings) {
         SaveRendererSettings(*renderer_settings);
@@ -272,6 +424,9 @@ bool Serialization::SerializeTransportCatalogue
     
     SaveGraph(transport_router.ExportInternalState().graph);
     SaveRouter(transport_router.ExportInternalState().router);
+    SaveContractionHierarchy(transport_router.ExportInternalState().contraction_hierarchy);
+    SaveLandmarks(transport_router.ExportInternalState().a_star_router);
+    SaveHubLabels(transport_router.ExportInternalState().hub_labels);
 
     bool result = serialized_catalogue_.SerializeToOstream(&out);
     ClearContainers();
@@ -280,12 +435,21 @@ bool Serialization::SerializeTransportCatalogue
 
 /* --- Deserialization --- */
 
+/* Deserialize Names */
+
+void Serialization::LoadNames(TransportCatalogue& transport_catalogue) {
+    const auto& p_names = serialized_catalogue_.names();
+    transport_catalogue.LoadNames(p_names.data(),
+                                  vector<uint32_t>(p_names.offsets().begin(), p_names.offsets().end()));
+}
+
 /* Deserialize Stops */
 
 void Serialization::LoadStops(TransportCatalogue& transport_catalogue) {
+    const domain::StringPool& names = transport_catalogue.GetNames();
     for (const auto& p_stop : serialized_catalogue_.stops()) {
         transport_catalogue.AddStop(p_stop.id(),
-                                    p_stop.name(),
+                                    names.Get(p_stop.name()),
                                     geo::Coordinates{p_stop.coordinates().latitude(),
                                                      p_stop.coordinates().longitude()});
     }
@@ -309,6 +473,7 @@ domain::BusType MakeDomainBusType(const tc_proto::BusType p_bus_type) {
 }
 
 void Serialization::LoadBuses(TransportCatalogue& transport_catalogue) {
+    const domain::StringPool& names = transport_catalogue.GetNames();
     for (const auto& p_bus : serialized_catalogue_.buses()) {
         vector<string> stop_names;
         stop_names.reserve(p_bus.stop_ids_size());
@@ -316,7 +481,7 @@ void Serialization::LoadBuses(TransportCatalogue& transport_catalogue) {
             stop_names.emplace_back(transport_catalogue.FindStop(stop_id)->name);
         }
         transport_catalogue.AddBus(p_bus.id(),
-                                   p_bus.bus_name(),
+                                   names.Get(p_bus.bus_name()),
                                    MakeDomainBusType(p_bus.bus_type()),
                                    move(stop_names));
     }
@@ -333,6 +498,96 @@ void Serialization::LoadDistances(TransportCatalogue& transport_catalogue) {
     }
 }
 
+/* Deserialize Bus infos */
+
+void Serialization::LoadBusInfos(TransportCatalogue& transport_catalogue) {
+    if (!serialized_catalogue_.has_bus_infos()) return;
+
+    const auto& p_bus_infos = serialized_catalogue_.bus_infos();
+    const int size = p_bus_infos.stops_count_size();
+    if (p_bus_infos.unique_stops_count_size() != size || p_bus_infos.geo_route_length_size() != size
+        || p_bus_infos.route_length_size() != size) {
+        throw invalid_argument("Bus infos fields sizes differ");
+    }
+    for (const domain::Bus& bus : transport_catalogue.GetAllBuses()) {
+        if (bus.id >= static_cast<size_t>(size)) {
+            throw invalid_argument("Bus infos don't cover all buses");
+        }
+    }
+    vector<domain::BusInfo> bus_infos(size);
+    for (size_t bus_id = 0; bus_id < bus_infos.size(); ++bus_id) {
+        const domain::Bus* bus = transport_catalogue.FindBus(bus_id);
+        if (!bus) continue;
+        auto& info = bus_infos[bus_id];
+        info.name = bus->name;
+        info.stops_count = p_bus_infos.stops_count(bus_id);
+        info.unique_stops_count = p_bus_infos.unique_stops_count(bus_id);
+        info.geo_route_length = p_bus_infos.geo_route_length(bus_id);
+        info.route_length = p_bus_infos.route_length(bus_id);
+        if (info.geo_route_length > 0) info.curvature = info.route_length / info.geo_route_length;
+    }
+    transport_catalogue.LoadBusInfos(move(bus_infos));
+}
+
+/* Deserialize Spatial index, index of base made without it is built */
+
+void Serialization::LoadSpatialIndex(TransportCatalogue& transport_catalogue) {
+    if (!serialized_catalogue_.has_spatial_index()) {
+        transport_catalogue.BuildSpatialIndex();
+        return;
+    }
+
+    const auto& p_spatial_index = serialized_catalogue_.spatial_index();
+    domain::SpatialIndex::Data data;
+    data.min = {p_spatial_index.min().latitude(), p_spatial_index.min().longitude()};
+    data.cell_lat = p_spatial_index.cell_lat();
+    data.cell_lng = p_spatial_index.cell_lng();
+    data.rows = p_spatial_index.rows();
+    data.cols = p_spatial_index.cols();
+    data.cell_offsets.assign(p_spatial_index.cell_offsets().begin(), p_spatial_index.cell_offsets().end());
+    data.points.reserve(p_spatial_index.stop_ids_size());
+    for (const uint32_t stop_id : p_spatial_index.stop_ids()) {
+        const domain::Stop* stop = transport_catalogue.FindStop(stop_id);
+        if (!stop) {
+            throw invalid_argument("Spatial index refers to unknown stop");
+        }
+        data.points.push_back({stop_id, stop->coordinates});
+    }
+    transport_catalogue.LoadSpatialIndex(move(data));
+}
+
+/* Deserialize Name index, index of base made without it is built */
+
+domain::NameKind MakeDomainNameKind(const tc_proto::NameKind p_name_kind) {
+    return p_name_kind == tc_proto::NameKind::BUS_NAME ? domain::NameKind::BUS : domain::NameKind::STOP;
+}
+
+void Serialization::LoadNameIndex(TransportCatalogue& transport_catalogue) {
+    if (!serialized_catalogue_.has_name_index()) {
+        transport_catalogue.BuildNameIndex();
+        return;
+    }
+
+    const auto& p_name_index = serialized_catalogue_.name_index();
+    const size_t entry_count = p_name_index.entry_names_size();
+    if (p_name_index.entry_kinds_size() != static_cast<int>(entry_count)
+        || p_name_index.entry_weights_size() != static_cast<int>(entry_count)) {
+        throw invalid_argument("Name index entries are inconsistent");
+    }
+    domain::NameIndex::Data data;
+    data.labels = p_name_index.labels();
+    data.subtree_ends.assign(p_name_index.subtree_ends().begin(), p_name_index.subtree_ends().end());
+    data.max_weights.assign(p_name_index.max_weights().begin(), p_name_index.max_weights().end());
+    data.entry_offsets.assign(p_name_index.entry_offsets().begin(), p_name_index.entry_offsets().end());
+    data.entries.reserve(entry_count);
+    for (size_t i = 0; i < entry_count; ++i) {
+        data.entries.push_back({p_name_index.entry_names(i),
+                                MakeDomainNameKind(p_name_index.entry_kinds(i)),
+                                p_name_index.entry_weights(i)});
+    }
+    transport_catalogue.LoadNameIndex(move(data));
+}
+
 /* Desrialize Renderer Settings */
 
 svg::Point MakePoint(svg_proto::Point p_point) {
@@ -386,61 +641,79 @@ void Serialization::LoadRendererSettings(optional<renderer::Renderer_Settings>&
 
 /* Deserialize Router Settings */
 
-optional<TransportRouter::Settings> Serialization::LoadRouterSettings() {
-    return transport_router::TransportRouter::Settings{
-                serialized_catalogue_.router_settings().bus_velocity(),
-                serialized_catalogue_.router_settings().bus_wait_time()};
-}
-
-/* Deserialize Graph */
-
-transport_router::EdgeWeight MakeEdgeWeight(const g_proto::EdgeWeight& p_weight) {
-    transport_router::EdgeWeight edge_weight;
-    edge_weight.total_time = p_weight.total_time();
-    edge_weight.stops_number = p_weight.stops_number();
-    edge_weight.bus_id = p_weight.bus_id();
-    return edge_weight;
+transport_router::RouterType MakeRouterType(const tr_proto::RouterType p_router_type) {
+    transport_router::RouterType router_type;
+    switch (p_router_type) {
+        case tr_proto::RouterType::DIJKSTRA :
+            router_type = transport_router::RouterType::DIJKSTRA;
+            break;
+        case tr_proto::RouterType::CONTRACTION_HIERARCHY :
+            router_type = transport_router::RouterType::CONTRACTION_HIERARCHY;
+            break;
+        case tr_proto::RouterType::RAPTOR :
+            router_type = transport_router::RouterType::RAPTOR;
+            break;
+        case tr_proto::RouterType::A_STAR :
+            router_type = transport_router::RouterType::A_STAR;
+            break;
+        case tr_proto::RouterType::HUB_LABELS :
+            router_type = transport_router::RouterType::HUB_LABELS;
+            break;
+        case tr_proto::RouterType::LAZY :
+            router_type = transport_router::RouterType::LAZY;
+            break;
+        default :
+            router_type = transport_router::RouterType::ALL_PAIRS;
+    }
+    return router_type;
 }
 
-graph::Edge<transport_router::EdgeWeight> MakeEdge(const g_proto::Edge& p_edge) {
-    graph::Edge<transport_router::EdgeWeight> edge;
-    edge.from = p_edge.vertex_id_from();
-    edge.to = p_edge.vertex_id_to();
-    edge.weight = MakeEdgeWeight(p_edge.weight());
-    return edge;
+transport_router::GraphModel MakeGraphModel(const tr_proto::GraphModel p_graph_model) {
+    return p_graph_model == tr_proto::GraphModel::TRANSFER ? transport_router::GraphModel::TRANSFER
+                                                           : transport_router::GraphModel::DIRECT;
 }
 
-vector<graph::Edge<transport_router::EdgeWeight>> LoadGraphEdges(const g_proto::Graph& p_graph) {
-    vector<graph::Edge<transport_router::EdgeWeight>> edges;
-    for (const auto& p_edge : p_graph.edges()) {
-        edges.push_back(MakeEdge(p_edge));
-    }
-    return edges;
+graph::RoutesTableAlgorithm MakeRoutesTableAlgorithm(const tr_proto::RoutesTableAlgorithm p_algorithm) {
+    return p_algorithm == tr_proto::RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA
+                          ? graph::RoutesTableAlgorithm::PER_SOURCE_DIJKSTRA
+                          : graph::RoutesTableAlgorithm::FLOYD_WARSHALL;
 }
 
-vector<graph::EdgeId> MakeIncedenceList(const g_proto::IncidenceList& p_incedence_list) {
-    vector<graph::EdgeId> incedence_list;
-    incedence_list.reserve(p_incedence_list.edge_id_size());
-    for (const auto& edge_id : p_incedence_list.edge_id()) {
-        incedence_list.push_back(edge_id);
-    }
-    return incedence_list;
+optional<TransportRouter::Settings> Serialization::LoadRouterSettings() {
+    const auto& p_settings = serialized_catalogue_.router_settings();
+    return transport_router::TransportRouter::Settings{
+                p_settings.bus_velocity(),
+                p_settings.bus_wait_time(),
+                MakeRouterType(p_settings.router_type()),
+                static_cast<size_t>(p_settings.route_cache_size()),
+                0,
+                MakeGraphModel(p_settings.graph_model()),
+                static_cast<size_t>(p_settings.landmark_count()),
+                static_cast<size_t>(p_settings.route_memory_limit()),
+                MakeRoutesTableAlgorithm(p_settings.routes_table_algorithm()),
+                p_settings.has_max_transfers() ? optional<size_t>{p_settings.max_transfers()} : nullopt};
 }
 
-vector<vector<graph::EdgeId>> LoadGraphIncedenceList(const g_proto::Graph& p_graph) {
-    vector<vector<graph::EdgeId>> incidence_list;
-    for (const auto& p_incidence_list : p_graph.incedence_lists()) {
-        incidence_list.push_back(MakeIncedenceList(p_incidence_list));
-    }
-    return incidence_list;
-}
+/* Deserialize Graph */
 
- void Serialization::LoadGraph(TransportRouter::Graph& graph) {
+void Serialization::LoadGraph(TransportRouter::Graph& graph) {
     if (!serialized_catalogue_.has_graph()) return;
 
     const auto& p_graph = serialized_catalogue_.graph();
-    graph.ExternalInitialization(LoadGraphEdges(p_graph), 
-                                 LoadGraphIncedenceList(p_graph));
+    vector<graph::EdgeId> offsets(p_graph.offsets().begin(), p_graph.offsets().end());
+
+    const size_t edges_count = p_graph.vertex_id_to_size();
+    vector<graph::Edge<transport_router::EdgeWeight>> edges(edges_count);
+    for (graph::VertexId vertex = 0; vertex + 1 < offsets.size(); ++vertex) {
+        for (graph::EdgeId edge_id = offsets[vertex]; edge_id < offsets[vertex + 1]; ++edge_id) {
+            edges[edge_id] = {vertex,
+                              p_graph.vertex_id_to(edge_id),
+                              transport_router::EdgeWeight{p_graph.total_time(edge_id),
+                                                           static_cast<int>(p_graph.stops_number(edge_id)),
+                                                           p_graph.bus_id(edge_id)}};
+        }
+    }
+    graph.ExternalInitialization(move(edges), move(offsets));
 }
 
 /* Deserialize Router */
@@ -453,37 +726,87 @@ transport_router::EdgeWeight MakeWeight(const tr_proto::Weight& p_weight) {
     return edge_weight;
 }
 
-optional<TransportRouter::Router::RouteInternalData>
-MakeRouteInternalData(const tr_proto::OptionalRouteData& p_route_data) {
-    TransportRouter::Router::RouteInternalData internal_data;
-    if (!p_route_data.has_route_data()) {
-        return nullopt;
+TransportRouter::Router::RoutesInternalData Serialization::LoadRouterData() {
+    const tr_proto::RoutesInternalData& 
+    p_routes_internal_data = serialized_catalogue_.routes_internal_data();
+
+    const size_t cells_count = p_routes_internal_data.weights_size();
+    if (static_cast<size_t>(p_routes_internal_data.prev_edges_size()) != cells_count) {
+        throw std::invalid_argument("Routes table weights and prev edges sizes differ");
     }
-    internal_data.weight = MakeWeight(p_route_data.route_data().weight());
-    optional<graph::EdgeId> prev_edge;
-    if (p_route_data.route_data().optional_prev_edge_case() == 
-            tr_proto::RouteData::OptionalPrevEdgeCase::kPrevEdge) {
-        internal_data.prev_edge = p_route_data.route_data().prev_edge();
-    } else {
-        internal_data.prev_edge = nullopt;
+    vector<graph::PackedRoutesTable::Cell> cells(cells_count);
+    for (size_t i = 0; i < cells_count; ++i) {
+        cells[i] = {p_routes_internal_data.weights(i), p_routes_internal_data.prev_edges(i)};
+    }
+    vector<uint32_t> component_ids(p_routes_internal_data.component_ids().begin(),
+                                   p_routes_internal_data.component_ids().end());
+    if (component_ids.empty()) {
+        component_ids.assign(p_routes_internal_data.vertex_count(), 0);
     }
-    return internal_data;
+    return TransportRouter::Router::RoutesInternalData(move(component_ids), move(cells));
 }
 
-TransportRouter::Router::RoutesInternalData Serialization::LoadRouterData() {
-    TransportRouter::Router::RoutesInternalData routes_internal_data;
+/* Deserialize Contraction Hierarchy */
 
-    const tr_proto::RoutesInternalData& 
-    p_routes_internal_data = serialized_catalogue_.routes_internal_data();
+graph::Shortcut<transport_router::EdgeWeight> MakeShortcut(const tr_proto::Shortcut& p_shortcut) {
+    graph::Shortcut<transport_router::EdgeWeight> shortcut;
+    shortcut.from = p_shortcut.vertex_id_from();
+    shortcut.to = p_shortcut.vertex_id_to();
+    shortcut.weight = MakeWeight(p_shortcut.weight());
+    shortcut.first_edge = p_shortcut.first_edge();
+    shortcut.second_edge = p_shortcut.second_edge();
+    return shortcut;
+}
 
-    for (const auto& p_vector : p_routes_internal_data.routes_internal_data()) {
-        vector<optional<TransportRouter::Router::RouteInternalData>> vector_data;
-        for (const auto& p_route_data : p_vector.optional_route_data()) {
-            vector_data.emplace_back(MakeRouteInternalData(p_route_data));
-        }
-        routes_internal_data.emplace_back(vector_data);
+void Serialization::LoadContractionHierarchy
+            (TransportRouter::ContractionHierarchy& contraction_hierarchy) {
+    if (!serialized_catalogue_.has_contraction_hierarchy()) return;
+
+    const tr_proto::ContractionHierarchy& 
+    p_contraction_hierarchy = serialized_catalogue_.contraction_hierarchy();
+
+    vector<size_t> vertex_ranks;
+    vertex_ranks.reserve(p_contraction_hierarchy.vertex_ranks_size());
+    for (const auto rank : p_contraction_hierarchy.vertex_ranks()) {
+        vertex_ranks.push_back(rank);
     }
-    return routes_internal_data;
+    vector<graph::Shortcut<transport_router::EdgeWeight>> shortcuts;
+    shortcuts.reserve(p_contraction_hierarchy.shortcuts_size());
+    for (const auto& p_shortcut : p_contraction_hierarchy.shortcuts()) {
+        shortcuts.push_back(MakeShortcut(p_shortcut));
+    }
+    contraction_hierarchy.ExternalInitialization(move(vertex_ranks), move(shortcuts));
+}
+
+/* Deserialize A* Landmarks */
+
+void Serialization::LoadLandmarks(TransportRouter::AStarRouter& a_star_router) {
+    if (!serialized_catalogue_.has_landmarks()) return;
+
+    const tr_proto::Landmarks& p_landmarks = serialized_catalogue_.landmarks();
+    a_star_router.ExternalInitialization(
+                {p_landmarks.vertex_ids().begin(), p_landmarks.vertex_ids().end()},
+                {p_landmarks.from_landmarks().begin(), p_landmarks.from_landmarks().end()},
+                {p_landmarks.to_landmarks().begin(), p_landmarks.to_landmarks().end()});
+}
+
+/* Deserialize Hub Labels */
+
+graph::HubLabelsData MakeHubLabelsData(const tr_proto::HubLabelsData& p_labels) {
+    return graph::HubLabelsData{{p_labels.offsets().begin(), p_labels.offsets().end()},
+                                {p_labels.hubs().begin(), p_labels.hubs().end()},
+                                {p_labels.keys().begin(), p_labels.keys().end()},
+                                {p_labels.edges().begin(), p_labels.edges().end()}};
+}
+
+void Serialization::LoadHubLabels(TransportRouter::HubLabels& hub_labels) {
+    if (!serialized_catalogue_.has_hub_labels()) return;
+
+    const tr_proto::HubLabels& p_hub_labels = serialized_catalogue_.hub_labels();
+    hub_labels.ExternalInitialization(
+                {p_hub_labels.hub_vertexes().begin(), p_hub_labels.hub_vertexes().end()},
+                MakeHubLabelsData(p_hub_labels.forward_labels()),
+                MakeHubLabelsData(p_hub_labels.backward_labels()));
 }
 
 bool Serialization::DeserializeTransportCatalogue
@@ -491,7 +814,10 @@ bool Serialization::DeserializeTransportCatalogue
                      std::optional<renderer::Renderer_Settings>& renderer_settings,
                      std::optional<TransportRouter::Settings>& transport_router_settings,
                      TransportRouter::Graph& graph,
-                     TransportRouter::Router& router) {
+                     TransportRouter::Router& router,
+                     TransportRouter::ContractionHierarchy& contraction_hierarchy,
+                     TransportRouter::AStarRouter& a_star_router,
+                     TransportRouter::HubLabels& hub_labels) {
 
     ifstream in(settings_.file_name, ios::binary);
     if (!in) {
@@ -502,9 +828,13 @@ bool Serialization::DeserializeTransportCatalogue
         return false;       // Error getting serialized data
     }
 
+    LoadNames(transport_catalogue);
     LoadStops(transport_catalogue);
     LoadBuses(transport_catalogue);
     LoadDistances(transport_catalogue);
+    LoadBusInfos(transport_catalogue);
+    LoadSpatialIndex(transport_catalogue);
+    LoadNameIndex(transport_catalogue);
 
     if (serialized_catalogue_.has_map_renderer_settings()) {
         LoadRendererSettings(renderer_settings);
@@ -518,6 +848,9 @@ bool Serialization::DeserializeTransportCatalogue
 
     LoadGraph(graph);
     router.ExternalInitialization(LoadRouterData());
+    LoadContractionHierarchy(contraction_hierarchy);
+    LoadLandmarks(a_star_router);
+    LoadHubLabels(hub_labels);
 
     ClearContainers();
     return true;
@@ -38,74 +38,102 @@ public:
                                        std::optional<renderer::Renderer_Settings>& renderer_settings,
                                        std::optional<TransportRouter::Settings>& transport_router_settings,
                                        TransportRouter::Graph& graph,
-                                       TransportRouter::Router& router);
+                                       TransportRouter::Router& router,
+                                       TransportRouter::ContractionHierarchy& contraction_hierarchy,
+                                       TransportRouter::AStarRouter& a_star_router,
+                                       TransportRouter::HubLabels& hub_labels);
 private:
     Serialization_Settings settings_;
     tc_proto::TransportCatalogue serialized_catalogue_;
     void ClearContainers();
 
     /* Serialization */
+    void SaveNames(const TransportCatalogue& transport_catalogue);
     void SaveStops(const TransportCatalogue& transport_catalogue);
     void SaveBuses(const TransportCatalogue& transport_catalogue);
     void SaveDistances(const TransportCatalogue& transport_catalogue);
+    void SaveBusInfos(const TransportCatalogue& transport_catalogue);
+    void SaveSpatialIndex(const TransportCatalogue& transport_catalogue);
+    void SaveNameIndex(const TransportCatalogue& transport_catalogue);
     void SaveRendererSettings(const std::optional<renderer::Renderer_Settings>& renderer_settings);
     void SaveTransportRouterSettings(const TransportRouter::Settings& router_settings);
-    void SaveGraph(const std::optional<TransportRouter::Graph>& graph);
-    void SaveRouter(const TransportRouter::Router& router);
+    void SaveGraph(const TransportRouter::Graph& graph);
+    void SaveRouter(const TransportRouter::Router* router);
+    void SaveContractionHierarchy(const TransportRouter::ContractionHierarchy* contraction_hierarchy);
+    void SaveLandmarks(const TransportRouter::AStarRouter* a_star_router);
+    void SaveHubLabels(const TransportRouter::HubLabels* hub_labels);
 
     /* Deserialization */
+    void LoadNames(TransportCatalogue& transport_catalogue);
     void LoadStops(TransportCatalogue& transport_catalogue);
     void LoadBuses(TransportCatalogue& transport_catalogue);
     void LoadDistances(TransportCatalogue& transport_catalogue);
+    void LoadBusInfos(TransportCatalogue& transport_catalogue);
+    void LoadSpatialIndex(TransportCatalogue& transport_catalogue);
+    void LoadNameIndex(TransportCatalogue& transport_catalogue);
     void LoadRendererSettings(std::optional<renderer::Renderer_Settings>& renderer_settings);
     std::optional<TransportRouter::Settings> LoadRouterSettings();
     void LoadGraph(TransportRouter::Graph& graph);
     TransportRouter::Router::RoutesInternalData LoadRouterData();
+    void LoadContractionHierarchy(TransportRouter::ContractionHierarchy& contraction_hierarchy);
+    void LoadLandmarks(TransportRouter::AStarRouter& a_star_router);
+    void LoadHubLabels(TransportRouter::HubLabels& hub_labels);
 };
 
 /* Serialize Stops */
 tc_proto::GeoCoordinates MakeProtoGeoCoordinates(double latitude, double longitude);
-tc_proto::Stop MakeProtoStop(const domain::Stop& stop);
+tc_proto::Stop MakeProtoStop(const domain::Stop& stop, const domain::StringPool& names);
 
 /* Serialize Buses */
 tc_proto::BusType MakeProtoBusType(const domain::BusType bus_type);
-tc_proto::Bus MakeProtoBus(const domain::Bus& bus);
+tc_proto::Bus MakeProtoBus(const domain::Bus& bus, const domain::StringPool& names);
 
 /* Serialize Distances */
 tc_proto::Distance MakeProtoDistances
             (uint32_t stop_id_from, uint32_t stop_id_to, int distance);
 
+/* Serialize Name index */
+tc_proto::NameKind MakeProtoNameKind(const domain::NameKind name_kind);
+
 /* Serialize Renderer Settings */
 svg_proto::Point MakeProtoPoint(const svg::Point& point);
 svg_proto::Color MakeProtoColor(const svg::Color& color);
 
-/* Serialize Graph */
-g_proto::EdgeWeight MakeProtoEdgeWeight(const graph::Edge<transport_router::EdgeWeight>& edge);
-g_proto::Edge MakeProtoEdge(const graph::Edge<transport_router::EdgeWeight>& edge);
-g_proto::IncidenceList MakeProtoIncedenceList
-            (const ranges::Range<std::vector<graph::EdgeId>::const_iterator> incident_edges);
+/* Serialize Transport Router settings */
+tr_proto::RouterType MakeProtoRouterType(const transport_router::RouterType router_type);
+tr_proto::GraphModel MakeProtoGraphModel(const transport_router::GraphModel graph_model);
 
 /* Serialize Router */
 tr_proto::Weight MakeProtoWeight(const transport_router::EdgeWeight& weight);
-tr_proto::RouteData MakeProtoRouteData
-            (const std::optional<TransportRouter::Router::RouteInternalData>& route_data);
+
+/* Serialize Contraction Hierarchy */
+tr_proto::Shortcut MakeProtoShortcut(const graph::Shortcut<transport_router::EdgeWeight>& shortcut);
+
+/* Serialize Hub Labels */
+tr_proto::HubLabelsData MakeProtoHubLabelsData(const graph::HubLabelsData& labels);
 
 /* Deserialize Buses */
 domain::BusType MakeDomainBusType(const tc_proto::BusType p_bus_type);
 
+/* Deserialize Name index */
+domain::NameKind MakeDomainNameKind(const tc_proto::NameKind p_name_kind);
+
 /* Desrialize Renderer Settings */
 svg::Point MakePoint(svg_proto::Point p_point);
 svg::Color MakeColor(const svg_proto::Color& p_color);
 
-/* Deserialize Graph */
-transport_router::EdgeWeight MakeEdgeWeight(const g_proto::EdgeWeight& p_weight);
-graph::Edge<transport_router::EdgeWeight> MakeEdge(const g_proto::Edge& p_edge);
-std::vector<graph::EdgeId> MakeIncedenceList(const g_proto::IncidenceList& p_incedence_list);
+/* Deserialize Router Settings */
+transport_router::RouterType MakeRouterType(const tr_proto::RouterType p_router_type);
+transport_router::GraphModel MakeGraphModel(const tr_proto::GraphModel p_graph_model);
 
 /* Deserialize Router */
 transport_router::EdgeWeight MakeWeight(const tr_proto::Weight& p_weight);
-std::optional<TransportRouter::Router::RouteInternalData> MakeRouteInternalData
-            (const tr_proto::OptionalRouteData& p_route_data);
+
+/* Deserialize Contraction Hierarchy */
+graph::Shortcut<transport_router::EdgeWeight> MakeShortcut(const tr_proto::Shortcut& p_shortcut);
+
+/* Deserialize Hub Labels */
+graph::HubLabelsData MakeHubLabelsData(const tr_proto::HubLabelsData& p_labels);
 
 } // namespace serialization
 
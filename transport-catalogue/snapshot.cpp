@@ -0,0 +1,99 @@
+#include "snapshot.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+namespace transport_catalogue {
+
+using namespace std;
+using transport_router::TransportRouter;
+
+Snapshot::Snapshot()
+    : request_handler_(catalogue_)
+    , transport_router_(request_handler_)
+{
+}
+
+/* Deserialize database and initialize transport router with deserialized graph and router */
+unique_ptr<Snapshot> Snapshot::Load(serialization::Serialization& serialization) {
+    unique_ptr<Snapshot> snapshot(new Snapshot());
+
+    // containers for deserialization
+    optional<TransportRouter::Settings> router_settings;
+    unique_ptr<TransportRouter::Graph> ptr_graph = make_unique<TransportRouter::Graph>(0);
+    unique_ptr<TransportRouter::Router> ptr_router = make_unique<TransportRouter::Router>(*ptr_graph);
+    unique_ptr<TransportRouter::ContractionHierarchy> ptr_contraction_hierarchy =
+                make_unique<TransportRouter::ContractionHierarchy>(*ptr_graph);
+    unique_ptr<TransportRouter::AStarRouter> ptr_a_star_router =
+                make_unique<TransportRouter::AStarRouter>(*ptr_graph);
+    unique_ptr<TransportRouter::HubLabels> ptr_hub_labels =
+                make_unique<TransportRouter::HubLabels>(*ptr_graph);
+    // deserialize
+    if (!serialization.DeserializeTransportCatalogue(snapshot->catalogue_,
+                                                     snapshot->renderer_settings_,
+                                                     router_settings,
+                                                     *ptr_graph,
+                                                     *ptr_router,
+                                                     *ptr_contraction_hierarchy,
+                                                     *ptr_a_star_router,
+                                                     *ptr_hub_labels)
+        || !router_settings) {
+        throw runtime_error("Can't load transport catalogue base");
+    }
+
+    snapshot->catalogue_.BuildStopIndex();
+
+    // start transport router
+    snapshot->transport_router_.SetSettings(move(*router_settings));
+    snapshot->transport_router_.ExternalInitialization(move(ptr_graph), move(ptr_router),
+                                                       move(ptr_contraction_hierarchy),
+                                                       move(ptr_a_star_router),
+                                                       move(ptr_hub_labels));
+    return snapshot;
+}
+
+const TransportCatalogue& Snapshot::GetCatalogue() const {
+    return catalogue_;
+}
+
+const RequestHandler& Snapshot::GetRequestHandler() const {
+    return request_handler_;
+}
+
+const optional<renderer::Renderer_Settings>& Snapshot::GetRendererSettings() const {
+    return renderer_settings_;
+}
+
+const TransportRouter& Snapshot::GetRouter() const {
+    return transport_router_;
+}
+
+TransportCatalogue& Snapshot::GetCatalogue() {
+    return catalogue_;
+}
+
+RequestHandler& Snapshot::GetRequestHandler() {
+    return request_handler_;
+}
+
+TransportRouter& Snapshot::GetRouter() {
+    return transport_router_;
+}
+
+void Snapshot::Freeze() {
+    catalogue_.BuildStopIndex();
+    catalogue_.BuildBusInfos(transport_router_.ExportInternalState().settings.thread_count);
+    catalogue_.BuildSpatialIndex();
+    catalogue_.BuildNameIndex();
+}
+
+shared_ptr<const Snapshot> SnapshotHolder::Get() const {
+    return atomic_load(&snapshot_);
+}
+
+void SnapshotHolder::Publish(shared_ptr<const Snapshot> snapshot) {
+    atomic_store(&snapshot_, move(snapshot));
+}
+
+} // namespace transport_catalogue
@@ -0,0 +1,67 @@
+#pragma once
+
+/* Immutable snapshot of transport catalogue with its router for serving requests.
+ * Writer loads or changes a snapshot through non-const access, rebuilds derived indexes by Freeze()
+ * and publishes it to SnapshotHolder as shared_ptr<const Snapshot>. Readers pin the current snapshot
+ * by SnapshotHolder::Get() for the duration of a request and see only const catalogue and router, so
+ * applying updates to the next snapshot never blocks them. Router searches keep their state per query,
+ * so readers of one snapshot don't lock each other either. A replaced snapshot is freed when its last
+ * reader unpins it.
+ */
+
+#include <memory>
+#include <optional>
+
+#include "transport_catalogue.h"
+#include "request_handler.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+#include "serialization.h"
+
+namespace transport_catalogue {
+
+class Snapshot {
+public:
+    /* Load snapshot from base file. Throws std::runtime_error if base can't be read */
+    static std::unique_ptr<Snapshot> Load(serialization::Serialization& serialization);
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /* Read access of published snapshot */
+    const TransportCatalogue& GetCatalogue() const;
+    const RequestHandler& GetRequestHandler() const;
+    const std::optional<renderer::Renderer_Settings>& GetRendererSettings() const;
+    const transport_router::TransportRouter& GetRouter() const;
+
+    /* Write access before snapshot is published */
+    TransportCatalogue& GetCatalogue();
+    RequestHandler& GetRequestHandler();
+    transport_router::TransportRouter& GetRouter();
+
+    /* Rebuild indexes derived from catalogue after it is changed, so const reads don't build them */
+    void Freeze();
+
+private:
+    Snapshot();
+
+    TransportCatalogue catalogue_;
+    RequestHandler request_handler_;
+    std::optional<renderer::Renderer_Settings> renderer_settings_;
+    transport_router::TransportRouter transport_router_;
+};
+
+/* Current published snapshot */
+class SnapshotHolder {
+public:
+    /* Pin current snapshot, nullptr if nothing is published */
+    std::shared_ptr<const Snapshot> Get() const;
+
+    /* Replace current snapshot, readers which pinned the previous one keep it */
+    void Publish(std::shared_ptr<const Snapshot> snapshot);
+
+private:
+    std::shared_ptr<const Snapshot> snapshot_;     /* accessed by atomic shared_ptr operations only */
+};
+
+} // namespace transport_catalogue
@@ -0,0 +1,173 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace domain {
+
+using namespace std;
+
+namespace {
+
+constexpr double DEGREE = M_PI / 180.;
+
+} // namespace
+
+void SpatialIndex::Build(vector<Point> points) {
+    data_ = Data{};
+    is_built_ = true;
+    if (points.empty()) {
+        data_.cell_offsets.assign(1, 0);
+        return;
+    }
+
+    geo::Coordinates min = points.front().coordinates;
+    geo::Coordinates max = min;
+    for (const Point& point : points) {
+        min.lat = std::min(min.lat, point.coordinates.lat);
+        min.lng = std::min(min.lng, point.coordinates.lng);
+        max.lat = std::max(max.lat, point.coordinates.lat);
+        max.lng = std::max(max.lng, point.coordinates.lng);
+    }
+
+    // split bounding box to cells roughly square in meters
+    const size_t cell_count = std::max<size_t>(1, points.size() / POINTS_PER_CELL);
+    const double height = max.lat - min.lat;
+    const double width = (max.lng - min.lng) * cos((min.lat + max.lat) / 2 * DEGREE);
+    size_t rows = 1;
+    if (width <= 0) {
+        rows = height > 0 ? cell_count : 1;
+    } else if (height > 0) {
+        rows = static_cast<size_t>(llround(sqrt(cell_count * height / width)));
+        rows = std::clamp<size_t>(rows, 1, cell_count);
+    }
+    const size_t cols = height > 0 || width > 0 ? std::max<size_t>(1, cell_count / rows) : 1;
+
+    data_.min = min;
+    data_.rows = static_cast<uint32_t>(rows);
+    data_.cols = static_cast<uint32_t>(cols);
+    data_.cell_lat = height > 0 ? height / rows : 1;
+    data_.cell_lng = max.lng > min.lng ? (max.lng - min.lng) / cols : 1;
+
+    // counting sort of points by cell
+    vector<size_t> point_cells(points.size());
+    data_.cell_offsets.assign(rows * cols + 1, 0);
+    for (size_t i = 0; i < points.size(); ++i) {
+        point_cells[i] = GetRow(points[i].coordinates.lat) * cols + GetCol(points[i].coordinates.lng);
+        ++data_.cell_offsets[point_cells[i] + 1];
+    }
+    for (size_t cell = 0; cell + 1 < data_.cell_offsets.size(); ++cell) {
+        data_.cell_offsets[cell + 1] += data_.cell_offsets[cell];
+    }
+    vector<uint32_t> next(data_.cell_offsets.begin(), data_.cell_offsets.end() - 1);
+    data_.points.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        data_.points[next[point_cells[i]]++] = points[i];
+    }
+}
+
+void SpatialIndex::Load(Data&& data) {
+    const size_t cell_count = static_cast<size_t>(data.rows) * data.cols;
+    if (data.cell_offsets.size() != cell_count + 1
+        || data.cell_offsets.front() != 0 || data.cell_offsets.back() != data.points.size()
+        || !is_sorted(data.cell_offsets.begin(), data.cell_offsets.end())
+        || !(data.cell_lat > 0) || !(data.cell_lng > 0)) {
+        throw invalid_argument("Spatial index data is inconsistent");
+    }
+    data_ = move(data);
+    is_built_ = true;
+}
+
+const SpatialIndex::Data& SpatialIndex::GetData() const {
+    return data_;
+}
+
+bool SpatialIndex::IsBuilt() const {
+    return is_built_;
+}
+
+void SpatialIndex::Clear() {
+    data_ = Data{};
+    is_built_ = false;
+}
+
+uint32_t SpatialIndex::GetRow(double lat) const {
+    const double row = floor((lat - data_.min.lat) / data_.cell_lat);
+    return static_cast<uint32_t>(std::clamp(row, 0., data_.rows - 1.));
+}
+
+uint32_t SpatialIndex::GetCol(double lng) const {
+    const double col = floor((lng - data_.min.lng) / data_.cell_lng);
+    return static_cast<uint32_t>(std::clamp(col, 0., data_.cols - 1.));
+}
+
+void SpatialIndex::CollectWithin(geo::Coordinates center, double radius, vector<Neighbor>& result) const {
+    // bounding box of the spherical cap, whole longitude range if it contains a pole or crosses 180 meridian
+    const double angle = radius / geo::EARTH_RADIUS;
+    uint32_t row_from = 0, row_to = data_.rows - 1;
+    uint32_t col_from = 0, col_to = data_.cols - 1;
+    if (angle < M_PI) {
+        const double lat_from = center.lat - angle / DEGREE;
+        const double lat_to = center.lat + angle / DEGREE;
+        if (lat_to < data_.min.lat || lat_from > data_.min.lat + data_.rows * data_.cell_lat) return;
+        row_from = GetRow(lat_from);
+        row_to = GetRow(lat_to);
+
+        const double sin_lng = sin(angle) / cos(center.lat * DEGREE);
+        if (lat_from > -90 && lat_to < 90 && sin_lng < 1) {
+            const double lng_from = center.lng - asin(sin_lng) / DEGREE;
+            const double lng_to = center.lng + asin(sin_lng) / DEGREE;
+            if (lng_from >= -180 && lng_to <= 180) {
+                if (lng_to < data_.min.lng || lng_from > data_.min.lng + data_.cols * data_.cell_lng) return;
+                col_from = GetCol(lng_from);
+                col_to = GetCol(lng_to);
+            }
+        }
+    }
+
+    for (uint32_t row = row_from; row <= row_to; ++row) {
+        const size_t cell = static_cast<size_t>(row) * data_.cols;
+        for (uint32_t i = data_.cell_offsets[cell + col_from]; i < data_.cell_offsets[cell + col_to + 1]; ++i) {
+            const Point& point = data_.points[i];
+            const double distance = geo::ComputeDistance(center, point.coordinates);
+            if (distance <= radius) {
+                result.push_back(Neighbor{point.id, distance});
+            }
+        }
+    }
+}
+
+vector<SpatialIndex::Neighbor>
+SpatialIndex::FindNearest(geo::Coordinates center, size_t count, double radius) const {
+    vector<Neighbor> result;
+    if (data_.points.empty()) return result;
+
+    // for count nearest widen search circle until it has enough points
+    double search_radius = radius;
+    if (count != 0) {
+        const double cell_size = std::max(data_.cell_lat, data_.cell_lng * cos(center.lat * DEGREE))
+                                 * DEGREE * geo::EARTH_RADIUS;
+        search_radius = std::min(radius, cell_size * std::max(1., sqrt(1. * count / POINTS_PER_CELL)));
+    }
+    while (true) {
+        result.clear();
+        CollectWithin(center, search_radius, result);
+        if ((count != 0 && result.size() >= count) || search_radius >= radius
+            || search_radius >= M_PI * geo::EARTH_RADIUS) {
+            break;
+        }
+        search_radius = std::min(radius, search_radius * 2);
+    }
+
+    sort(result.begin(), result.end(), [](const Neighbor& lhs, const Neighbor& rhs) {
+        return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.id < rhs.id);
+    });
+    if (count != 0 && result.size() > count) {
+        result.resize(count);
+    }
+    return result;
+}
+
+} // namespace domain
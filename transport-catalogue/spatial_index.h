@@ -0,0 +1,71 @@
+#pragma once
+
+/* Static grid over points on the Earth surface. Bounding box of points is split to cells of equal
+ * size in degrees, about POINTS_PER_CELL points per cell, cells are roughly square in meters.
+ * Points are sorted by cell: points of cell i = points[cell_offsets[i], cell_offsets[i + 1]),
+ * cell index = row * cols + col. Query scans only cells overlapping the bounding box of
+ * the search circle and checks points by geo::ComputeDistance.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "geo.h"
+
+namespace domain {
+
+class SpatialIndex {
+public:
+    struct Point {
+        uint32_t id;
+        geo::Coordinates coordinates;
+    };
+
+    struct Neighbor {
+        uint32_t id;
+        double distance;            /* meters */
+    };
+
+    /* grid layout and points sorted by cell */
+    struct Data {
+        geo::Coordinates min{0, 0}; /* south-west corner of the grid */
+        double cell_lat = 1;        /* cell size, degrees */
+        double cell_lng = 1;
+        uint32_t rows = 0;
+        uint32_t cols = 0;
+        std::vector<uint32_t> cell_offsets;
+        std::vector<Point> points;
+    };
+
+    static constexpr double NO_RADIUS = std::numeric_limits<double>::infinity();
+
+    void Build(std::vector<Point> points);
+
+    /* Replace index by loaded one, throws std::invalid_argument if data is inconsistent */
+    void Load(Data&& data);
+
+    const Data& GetData() const;
+
+    bool IsBuilt() const;
+
+    void Clear();
+
+    /* Points not farther than radius meters from center, at most count nearest of them (0 - no limit),
+       sorted by distance */
+    std::vector<Neighbor> FindNearest(geo::Coordinates center, size_t count, double radius = NO_RADIUS) const;
+
+private:
+    static constexpr size_t POINTS_PER_CELL = 4;
+
+    /* add points within radius, only cells overlapping bounding box of the circle are scanned */
+    void CollectWithin(geo::Coordinates center, double radius, std::vector<Neighbor>& result) const;
+    uint32_t GetRow(double lat) const;
+    uint32_t GetCol(double lng) const;
+
+    Data data_;
+    bool is_built_ = false;
+};
+
+} // namespace domain
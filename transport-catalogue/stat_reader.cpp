@@ -61,6 +61,7 @@ void StatReader::AnswerStop(string_view name) {
         return;
     }
     
+    catalogue_.BuildStopIndex();
     const StopInfo info = catalogue_.GetStopInfo(name);
     if (info.empty()) {
         output_ << "Stop " << name << ": no buses" << endl;
@@ -0,0 +1,103 @@
+#include "string_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace domain {
+
+using namespace std;
+
+string_view StringPool::Store(string_view name) {
+    if (name.empty()) return {};
+
+    if (name.size() > free_size_) {
+        const size_t chunk_size = max(CHUNK_SIZE, name.size());
+        chunks_.push_back(make_unique<char[]>(chunk_size));
+        free_begin_ = chunks_.back().get();
+        free_size_ = chunk_size;
+    }
+    char* data = free_begin_;
+    memcpy(data, name.data(), name.size());
+    free_begin_ += name.size();
+    free_size_ -= name.size();
+    return string_view{data, name.size()};
+}
+
+StringPool::Handle StringPool::Intern(string_view name) {
+    if (auto it = handles_.find(name); it != handles_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= numeric_limits<Handle>::max()) {
+        throw length_error("Too many names in string pool");
+    }
+    const Handle handle = static_cast<Handle>(names_.size());
+    names_.push_back(Store(name));
+    handles_.emplace(names_.back(), handle);
+    return handle;
+}
+
+optional<StringPool::Handle> StringPool::Find(string_view name) const {
+    if (auto it = handles_.find(name); it != handles_.end()) {
+        return it->second;
+    }
+    return nullopt;
+}
+
+string_view StringPool::Get(Handle handle) const {
+    return names_.at(handle);
+}
+
+size_t StringPool::GetSize() const {
+    return names_.size();
+}
+
+string StringPool::MakeBlob() const {
+    string blob;
+    for (const string_view name : names_) {
+        blob += name;
+    }
+    return blob;
+}
+
+vector<uint32_t> StringPool::MakeOffsets() const {
+    vector<uint32_t> offsets;
+    offsets.reserve(names_.size() + 1);
+    uint32_t offset = 0;
+    offsets.push_back(offset);
+    for (const string_view name : names_) {
+        offset += static_cast<uint32_t>(name.size());
+        offsets.push_back(offset);
+    }
+    return offsets;
+}
+
+void StringPool::Load(string_view blob, const vector<uint32_t>& offsets) {
+    if (!offsets.empty() && (offsets.front() != 0 || offsets.back() != blob.size()
+                             || !is_sorted(offsets.begin(), offsets.end()))) {
+        throw invalid_argument("String pool offsets don't match blob");
+    }
+    chunks_.clear();
+    names_.clear();
+    handles_.clear();
+    free_begin_ = nullptr;
+    free_size_ = 0;
+
+    // whole blob is one chunk, names are views into it
+    const char* data = nullptr;
+    if (!blob.empty()) {
+        chunks_.push_back(make_unique<char[]>(blob.size()));
+        memcpy(chunks_.back().get(), blob.data(), blob.size());
+        data = chunks_.back().get();
+    }
+    const size_t name_count = offsets.empty() ? 0 : offsets.size() - 1;
+    names_.reserve(name_count);
+    handles_.reserve(name_count);
+    for (size_t handle = 0; handle < name_count; ++handle) {
+        names_.emplace_back(data + offsets[handle], offsets[handle + 1] - offsets[handle]);
+        handles_.emplace(names_.back(), static_cast<Handle>(handle));
+    }
+}
+
+} // namespace domain
@@ -0,0 +1,57 @@
+#pragma once
+
+/* Pool of interned stop and bus names. Every distinct name is stored once in arena of large chunks
+ * and identified by 32-bit handle. Chunks never move, so string_views to names are valid
+ * while the pool lives. Pool is stored as a single blob with name offsets, loaded blob
+ * becomes one chunk of arena.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace domain {
+
+class StringPool {
+public:
+    using Handle = uint32_t;
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /* Handle of the name, name is added to the pool if it is not there yet */
+    Handle Intern(std::string_view name);
+
+    /* Handle of the name if it is in the pool */
+    std::optional<Handle> Find(std::string_view name) const;
+
+    /* Name by handle, view is valid while the pool lives */
+    std::string_view Get(Handle handle) const;
+
+    size_t GetSize() const;
+
+    /* All names as one blob and offsets: name of handle i = blob[offsets[i], offsets[i + 1]) */
+    std::string MakeBlob() const;
+    std::vector<uint32_t> MakeOffsets() const;
+
+    /* Replace pool content by names from blob, handles are kept */
+    void Load(std::string_view blob, const std::vector<uint32_t>& offsets);
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;   /* bytes, longer names get chunk of their own */
+
+    std::string_view Store(std::string_view name);
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* free_begin_ = nullptr;                    /* free bytes at the end of the last chunk */
+    size_t free_size_ = 0;
+    std::vector<std::string_view> names_;           /* index = handle */
+    std::unordered_map<std::string_view, Handle> handles_;
+};
+
+} // namespace domain
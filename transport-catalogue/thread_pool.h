@@ -0,0 +1,127 @@
+#pragma once
+
+/* Fixed size pool of worker threads for data parallel loops.
+ * ParallelFor splits [0, count) among workers and the calling thread,
+ * each index is taken from shared atomic counter, so faster threads take more work.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+class ThreadPool {
+public:
+    /* thread_count - total number of threads including calling thread, 0 - hardware concurrency */
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const;
+
+    /* Call func(index) for every index in [0, count). Blocks until all calls are done */
+    template <typename Func>
+    void ParallelFor(size_t count, Func&& func);
+
+private:
+    void WorkerLoop();
+    void RunJob();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable job_started_;
+    std::condition_variable job_finished_;
+
+    std::function<void(size_t)> job_;
+    size_t job_count_ = 0;
+    std::atomic<size_t> next_index_{0};
+    size_t job_generation_ = 0;     /* incremented for every new job */
+    size_t busy_workers_ = 0;
+    bool stop_ = false;
+};
+
+inline ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    job_started_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+inline size_t ThreadPool::GetThreadCount() const {
+    return workers_.size() + 1;
+}
+
+inline void ThreadPool::RunJob() {
+    for (size_t index = next_index_++; index < job_count_; index = next_index_++) {
+        job_(index);
+    }
+}
+
+inline void ThreadPool::WorkerLoop() {
+    size_t done_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            job_started_.wait(lock, [&] { return stop_ || job_generation_ != done_generation; });
+            if (stop_) return;
+            done_generation = job_generation_;
+        }
+        RunJob();
+        {
+            std::lock_guard lock(mutex_);
+            --busy_workers_;
+        }
+        job_finished_.notify_one();
+    }
+}
+
+template <typename Func>
+void ThreadPool::ParallelFor(size_t count, Func&& func) {
+    if (count == 0) return;
+    if (workers_.empty() || count == 1) {
+        for (size_t index = 0; index < count; ++index) {
+            func(index);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        job_ = std::ref(func);
+        job_count_ = count;
+        next_index_ = 0;
+        busy_workers_ = workers_.size();
+        ++job_generation_;
+    }
+    job_started_.notify_all();
+
+    RunJob();
+
+    std::unique_lock lock(mutex_);
+    job_finished_.wait(lock, [&] { return busy_workers_ == 0; });
+    job_ = nullptr;
+}
+
+}  // namespace parallel
@@ -1,5 +1,9 @@
 #include "transport_catalogue.h"
+#include "thread_pool.h"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <unordered_set>
 #include <functional>
 
@@ -7,54 +11,85 @@ namespace transport_catalogue {
 
 using namespace std;
 
+namespace {
+
+/* ids are dense, so id index is a vector with nullptr for missing ids */
+template <typename T>
+void SetById(vector<const T*>& index, size_t id, const T* item) {
+    if (id >= index.size()) index.resize(id + 1, nullptr);
+    index[id] = item;
+}
+
+} // namespace
+
 void TransportCatalogue::AddStop
-            (const string& name, const geo::Coordinates& coordinates) {
-    stop_id_ = std::max(stop_id_, stops_.size());
-    AddStop(stop_id_, name, coordinates);
-    ++stop_id_;
+            (const string_view name, const geo::Coordinates& coordinates) {
+    AddStop(next_stop_id_, name, coordinates);
 }
 
 void TransportCatalogue::AddStop
-            (size_t stop_id, const std::string &name, const geo::Coordinates &coordinates) {
-    Stop& stop = stops_.emplace_back(Stop{stop_id, name, coordinates});
-    stopname_to_stop_[string_view{stop.name}] = &stop;
-    stop_id_to_stop_[stop_id] = &stop;
+            (size_t stop_id, const string_view name, const geo::Coordinates &coordinates) {
+    Stop& stop = stops_.emplace_back(Stop{stop_id, names_.Get(names_.Intern(name)), coordinates});
+    stopname_to_stop_[stop.name] = &stop;
+    SetById(stop_id_to_stop_, stop_id, &stop);
+    next_stop_id_ = std::max(next_stop_id_, stop_id + 1);    // ids of later added stops never repeat loaded ones
+    is_stop_index_built_ = false;
+    stops_grid_.Clear();
+    name_index_.Clear();
 }
 
 void TransportCatalogue::AddBus
-            (const string& name, BusType type, const vector<string>& stop_names) {
-    bus_id_ = std::max(bus_id_, buses_.size());
-    AddBus(bus_id_, name, type, stop_names);
-    ++bus_id_;
+            (const string_view name, BusType type, const vector<string>& stop_names) {
+    AddBus(next_bus_id_, name, type, stop_names);
 }
 
 void TransportCatalogue::AddBus
-            (size_t bus_id, const string& name, BusType type, const vector<string>& stop_names) {
+            (size_t bus_id, const string_view name, BusType type, const vector<string>& stop_names) {
     vector<const Stop*> stops;
     for (const string& stopname : stop_names) {
         stops.push_back(stopname_to_stop_.at(stopname));
     }
-    Bus& bus = buses_.emplace_back(Bus{bus_id, name, type, move(stops)});
-    busname_to_bus_[string_view{bus.name}] = &bus;
-    bus_id_to_bus_[bus_id] = &bus;
+    Bus& bus = buses_.emplace_back(Bus{bus_id, names_.Get(names_.Intern(name)), type, move(stops)});
+    next_bus_id_ = std::max(next_bus_id_, bus_id + 1);    // ids of later added buses never repeat loaded ones
+    bus_infos_.clear();
+    name_index_.Clear();
+    busname_to_bus_[bus.name] = &bus;
+    SetById(bus_id_to_bus_, bus_id, &bus);
+    is_stop_index_built_ = false;
+}
 
-    /* add bus to all stops */
-    for (const auto stop : bus.stops) {
-        stop_to_buses_[stop->name].insert(string_view(bus.name));
+bool TransportCatalogue::RemoveBus(const string_view name) {
+    auto it = find_if(buses_.begin(), buses_.end(), [name](const Bus& bus) { return bus.name == name; });
+    if (it == buses_.end()) return false;
+    buses_.erase(it);
+    bus_infos_.clear();
+    name_index_.Clear();
+
+    /* erase from deque invalidates pointers to other buses, so rebuild indexes */
+    busname_to_bus_.clear();
+    fill(bus_id_to_bus_.begin(), bus_id_to_bus_.end(), nullptr);
+    for (const Bus& bus : buses_) {
+        busname_to_bus_[bus.name] = &bus;
+        bus_id_to_bus_[bus.id] = &bus;
     }
+    is_stop_index_built_ = false;
+    return true;
 }
 
 void TransportCatalogue::SetDistance
             (const string& from_stop, const string& to_stop, const int distance) {
     const Stop* from = stopname_to_stop_.at(from_stop);
     const Stop* to = stopname_to_stop_.at(to_stop);
-    distances_[pair{from, to}] = distance;
+    distances_.Set(from->id, to->id, distance);
+    bus_infos_.clear();
 }
 
 void TransportCatalogue::SetDistance(size_t from_stop, size_t to_stop, const int distance) {
-    const Stop* from = stop_id_to_stop_.at(from_stop);
-    const Stop* to = stop_id_to_stop_.at(to_stop);
-    distances_[pair{from, to}] = distance;
+    if (!FindStop(from_stop) || !FindStop(to_stop)) {
+        throw out_of_range("Unknown stop id");
+    }
+    distances_.Set(from_stop, to_stop, distance);
+    bus_infos_.clear();
 }
 
 const Stop* TransportCatalogue::FindStop(const string_view name) const {
@@ -66,11 +101,7 @@ const Stop* TransportCatalogue::FindStop(const string_view name) const {
 }
 
 const Stop* TransportCatalogue::FindStop(size_t id) const {
-    auto it = stop_id_to_stop_.find(id);
-    if (it != stop_id_to_stop_.end()) {
-        return it->second;
-    }    
-    return nullptr;
+    return id < stop_id_to_stop_.size() ? stop_id_to_stop_[id] : nullptr;
 }
 
 const Bus* TransportCatalogue::FindBus(const string_view name) const {
@@ -82,11 +113,7 @@ const Bus* TransportCatalogue::FindBus(const string_view name) const {
 }
 
 const Bus* TransportCatalogue::FindBus(size_t id) const {
-    auto it = bus_id_to_bus_.find(id);
-    if (it != bus_id_to_bus_.end()) {
-        return it->second;
-    }
-    return nullptr;
+    return id < bus_id_to_bus_.size() ? bus_id_to_bus_[id] : nullptr;
 }
 
 const std::deque<Stop>& TransportCatalogue::GetAllStops() const {
@@ -99,13 +126,7 @@ const std::deque<Bus>& TransportCatalogue::GetAllBuses() const {
 
 int TransportCatalogue::GetDistance(const Stop* from, const Stop* to) const {
     if (!from || !to) return 0;
-
-    if (distances_.count(pair{from, to}) != 0) {
-        return distances_.at(pair{from, to});
-    } else if (distances_.count(pair{to, from}) != 0) {
-        return distances_.at(pair{to, from});
-    }
-    return 0;
+    return distances_.Get(from->id, to->id);
 }
 
 int TransportCatalogue::GetDistance(const string& from_stop, const string& to_stop) const {
@@ -115,71 +136,210 @@ int TransportCatalogue::GetDistance(const string& from_stop, const string& to_st
 }
 
 int TransportCatalogue::GetDistance(const size_t from_stop_id, const size_t to_stop_id) const {
-    const Stop* from = FindStop(from_stop_id);
-    const Stop* to = FindStop(to_stop_id);
-    return GetDistance(from, to);
+    if (!FindStop(from_stop_id) || !FindStop(to_stop_id)) return 0;
+    return distances_.Get(from_stop_id, to_stop_id);
 }
 
 const BusInfo
 TransportCatalogue::GetBusInfo(const string_view name) const {
     const Bus* bus = FindBus(name);
     if (!bus) return {};
+    if (bus->id < bus_infos_.size()) {
+        return bus_infos_[bus->id];
+    }
+    return ComputeBusInfo(*bus);
+}
 
+void TransportCatalogue::BuildBusInfos(size_t thread_count) {
+    vector<BusInfo> bus_infos(bus_id_to_bus_.size());
+    parallel::ThreadPool thread_pool(thread_count);
+    thread_pool.ParallelFor(buses_.size(), [&](size_t index) {
+        const Bus& bus = buses_[index];
+        bus_infos[bus.id] = ComputeBusInfo(bus);
+    });
+    bus_infos_ = move(bus_infos);
+}
+
+const vector<BusInfo>& TransportCatalogue::GetBusInfos() const {
+    return bus_infos_;
+}
+
+void TransportCatalogue::LoadBusInfos(vector<BusInfo>&& bus_infos) {
+    // infos of removed buses with the greatest ids may be kept in the table
+    if (bus_infos.size() < bus_id_to_bus_.size()) {
+        throw invalid_argument("Bus infos don't match buses");
+    }
+    bus_infos.resize(bus_id_to_bus_.size());
+    bus_infos_ = move(bus_infos);
+}
+
+BusInfo TransportCatalogue::ComputeBusInfo(const Bus& bus) const {
     double geo_route_length = 0.0;
     int route_length = 0;
     double curvature = 1.0;
     int unique_stops_count = 0;
-    int stop_count = static_cast<int>(bus->stops.size());
+    int stop_count = static_cast<int>(bus.stops.size());
     if (stop_count > 0) {
-        unordered_set<string_view> unique_stops;
-        unique_stops.insert(bus->stops.front()->name);
+        // stop names are unique, so stops are compared by pointers
+        vector<const Stop*> unique_stops(bus.stops.begin(), bus.stops.end());
+        sort(unique_stops.begin(), unique_stops.end());
+        unique_stops_count = static_cast<int>(unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin());
 
         /* bus goes forward */
-        for (auto it1 = bus->stops.begin(), it2 = it1 + 1; it2 != bus->stops.end(); ++it1, ++it2) {
+        for (auto it1 = bus.stops.begin(), it2 = it1 + 1; it2 != bus.stops.end(); ++it1, ++it2) {
             geo_route_length += geo::ComputeDistance((*it1)->coordinates, (*it2)->coordinates);
-            const int& distance = GetDistance((*it1)->name, (*it2)->name);
+            const int& distance = GetDistance(*it1, *it2);
             route_length += (distance != 0) ? distance : static_cast<int>(geo_route_length);
-            unique_stops.insert((*it2)->name);
         }
 
         /* bus goes backward if route linear */
-        if (bus->type == BusType::LINEAR) {
-            for (auto it1 = bus->stops.rbegin(), it2 = it1 + 1; it2 != bus->stops.rend(); ++it1, ++it2) {
+        if (bus.type == BusType::LINEAR) {
+            for (auto it1 = bus.stops.rbegin(), it2 = it1 + 1; it2 != bus.stops.rend(); ++it1, ++it2) {
                 geo_route_length += geo::ComputeDistance((*it1)->coordinates, (*it2)->coordinates);
-                const int& distance = GetDistance((*it1)->name, (*it2)->name);
+                const int& distance = GetDistance(*it1, *it2);
                 route_length += (distance != 0) ? distance : static_cast<int>(geo_route_length);
             }
             
             /* unique case than only 2 stops and 1st stop == last stop */
-            if (stop_count == 2 && bus->stops.front() == bus->stops.back()) {
+            if (stop_count == 2 && bus.stops.front() == bus.stops.back()) {
                 stop_count = 1;    
             } else {
-                stop_count += static_cast<int>(bus->stops.size()) - 1;
+                stop_count += static_cast<int>(bus.stops.size()) - 1;
             }
         }
-        
-        unique_stops_count = static_cast<int>(unique_stops.size());
+
         if (geo_route_length > 0) curvature = route_length / geo_route_length;
     }
-    return {string{bus->name}, stop_count, unique_stops_count, geo_route_length, route_length, curvature};
+    return {bus.name, stop_count, unique_stops_count, geo_route_length, route_length, curvature};
+}
+
+const StringPool& TransportCatalogue::GetNames() const {
+    return names_;
+}
+
+void TransportCatalogue::LoadNames(const string_view blob, const vector<uint32_t>& offsets) {
+    if (!stops_.empty() || !buses_.empty()) {
+        throw logic_error("Names are loaded after stops or buses have been added");
+    }
+    names_.Load(blob, offsets);
 }
 
-const std::unordered_map<std::pair<const Stop *, const Stop *>, int, StopHasher>&
-TransportCatalogue::GetDistances() const {
+const DistanceTable& TransportCatalogue::GetDistances() const {
     return distances_;
 }
 
-/* get all buses names passes the stop. all buses names unique and sorted by name */
-const StopInfo&
-TransportCatalogue::GetStopInfo(const string_view stop_name) const {
-    static const StopInfo empty{};
+void TransportCatalogue::BuildSpatialIndex() {
+    vector<SpatialIndex::Point> points;
+    points.reserve(stops_.size());
+    for (const Stop& stop : stops_) {
+        if (stop.id >= numeric_limits<uint32_t>::max()) {
+            throw length_error("Stop id doesn't fit spatial index");
+        }
+        points.push_back(SpatialIndex::Point{static_cast<uint32_t>(stop.id), stop.coordinates});
+    }
+    stops_grid_.Build(move(points));
+}
 
-    auto stop_ptr = stop_to_buses_.find(stop_name);
-    if (stop_ptr != stop_to_buses_.end()) {
-        return std::cref(stop_ptr->second);
+const SpatialIndex& TransportCatalogue::GetSpatialIndex() const {
+    return stops_grid_;
+}
+
+void TransportCatalogue::LoadSpatialIndex(SpatialIndex::Data&& data) {
+    stops_grid_.Load(move(data));
+}
+
+void TransportCatalogue::BuildNameIndex() {
+    BuildStopIndex();       // stops are weighted by their buses
+    vector<NameIndex::Entry> entries;
+    entries.reserve(stops_.size() + buses_.size());
+    for (const Stop& stop : stops_) {
+        const uint32_t bus_count = static_cast<uint32_t>(GetStopInfo(stop.name).size());
+        entries.push_back(NameIndex::Entry{*names_.Find(stop.name), NameKind::STOP, bus_count});
+    }
+    for (const Bus& bus : buses_) {
+        vector<const Stop*> stops = bus.stops;
+        sort(stops.begin(), stops.end());
+        const uint32_t stop_count = static_cast<uint32_t>(unique(stops.begin(), stops.end()) - stops.begin());
+        entries.push_back(NameIndex::Entry{*names_.Find(bus.name), NameKind::BUS, stop_count});
     }
+    name_index_.Build(move(entries), names_);
+}
+
+const NameIndex& TransportCatalogue::GetNameIndex() const {
+    return name_index_;
+}
+
+void TransportCatalogue::LoadNameIndex(NameIndex::Data&& data) {
+    for (const NameIndex::Entry& entry : data.entries) {
+        if (entry.name >= names_.GetSize()) {
+            throw invalid_argument("Name index refers to unknown name");
+        }
+    }
+    name_index_.Load(move(data));
+}
+
+vector<NameSuggestion>
+TransportCatalogue::SuggestNames(const string_view query, size_t count, size_t max_distance) const {
+    if (!name_index_.IsBuilt()) {
+        throw logic_error("Name index is not built");
+    }
+    vector<NameSuggestion> result;
+    for (const auto& [entry, distance] : name_index_.Find(query, count, max_distance)) {
+        result.push_back(NameSuggestion{names_.Get(entry.name), entry.kind, distance});
+    }
+    return result;
+}
 
-    return empty;
+vector<pair<const Stop*, double>>
+TransportCatalogue::FindNearbyStops(geo::Coordinates center, size_t count, double radius) const {
+    if (!stops_grid_.IsBuilt()) {
+        throw logic_error("Spatial index is not built");
+    }
+    vector<pair<const Stop*, double>> result;
+    for (const auto& [stop_id, distance] : stops_grid_.FindNearest(center, count, radius)) {
+        result.emplace_back(stop_id_to_stop_[stop_id], distance);
+    }
+    return result;
+}
+
+/* get all buses names passes the stop. all buses names unique and sorted by name */
+StopInfo TransportCatalogue::GetStopInfo(const string_view stop_name) const {
+    if (!is_stop_index_built_) {
+        throw logic_error("Stop index is not built");
+    }
+    const Stop* stop = FindStop(stop_name);
+    if (!stop) return StopInfo{nullptr, nullptr};
+
+    const string_view* buses = stop_buses_.data();
+    return StopInfo{buses + stop_buses_offsets_[stop->id], buses + stop_buses_offsets_[stop->id + 1]};
+}
+
+void TransportCatalogue::BuildStopIndex() {
+    if (!is_stop_index_built_) UpdateStopIndex();
+}
+
+/* (stop id, bus name) pairs sorted and packed to CSR */
+void TransportCatalogue::UpdateStopIndex() {
+    vector<pair<size_t, string_view>> stop_buses;
+    for (const Bus& bus : buses_) {
+        for (const Stop* stop : bus.stops) {
+            stop_buses.emplace_back(stop->id, bus.name);
+        }
+    }
+    sort(stop_buses.begin(), stop_buses.end());
+    stop_buses.erase(unique(stop_buses.begin(), stop_buses.end()), stop_buses.end());
+
+    stop_buses_offsets_.assign(stop_id_to_stop_.size() + 1, 0);
+    stop_buses_.clear();
+    stop_buses_.reserve(stop_buses.size());
+    for (const auto& [stop_id, bus_name] : stop_buses) {
+        ++stop_buses_offsets_[stop_id + 1];
+        stop_buses_.push_back(bus_name);
+    }
+    for (size_t stop_id = 0; stop_id + 1 < stop_buses_offsets_.size(); ++stop_id) {
+        stop_buses_offsets_[stop_id + 1] += stop_buses_offsets_[stop_id];
+    }
+    is_stop_index_built_ = true;
 }
 
 namespace detail {
@@ -8,9 +8,14 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
+#include <vector>
 
 #include "geo.h"
 #include "domain.h"
+#include "distance_table.h"
+#include "name_index.h"
+#include "spatial_index.h"
+#include "string_pool.h"
 
 namespace transport_catalogue {
 using namespace domain;
@@ -18,16 +23,19 @@ using namespace domain;
 class TransportCatalogue {
 public:
     /* Add Stop to database */
-    void AddStop(const std::string& name, const geo::Coordinates& coordinates);
+    void AddStop(const std::string_view name, const geo::Coordinates& coordinates);
 
     /* Add Stop with specified id to database */
-    void AddStop(size_t stop_id, const std::string& name, const geo::Coordinates& coordinates);
+    void AddStop(size_t stop_id, const std::string_view name, const geo::Coordinates& coordinates);
 
     /* Add Bus to database */
-    void AddBus(const std::string& name, BusType type, const std::vector<std::string>& stop_names);
+    void AddBus(const std::string_view name, BusType type, const std::vector<std::string>& stop_names);
 
     /* Add Bus with specified id to database */
-    void AddBus(size_t bus_id, const std::string& name, BusType type, const std::vector<std::string>& stop_names);
+    void AddBus(size_t bus_id, const std::string_view name, BusType type, const std::vector<std::string>& stop_names);
+
+    /* Remove Bus from database. Returns false if there is no such bus */
+    bool RemoveBus(const std::string_view name);
 
     /* Add Distance (between Stops) to database */
     void SetDistance(const std::string& from_stop, const std::string& to_stop, const int distance);
@@ -62,33 +70,88 @@ public:
     /* Get distance between two Stops in meters (if set) */
     int GetDistance(const size_t from_stop_id, const size_t to_stop_id) const;
 
-    /* Get Info about Stop */
-    const StopInfo& GetStopInfo(const std::string_view name) const;
+    /* Get Info about Stop. View is valid until Stops or Buses are changed.
+       Throws std::logic_error if stop-to-buses index is not built or outdated */
+    StopInfo GetStopInfo(const std::string_view name) const;
+
+    /* Build stop-to-buses index if Stops or Buses are changed since it was built. Changes only mark
+       the index outdated, so many changes are followed by a single rebuild */
+    void BuildStopIndex();
 
-    /* Get Info about Bus (route) */
+    /* Get Info about Bus (route), precomputed one if table of infos is built */
     const BusInfo GetBusInfo(const std::string_view name) const;
 
+    /* Precompute infos of all Buses. Table is dropped when Buses or Distances are changed.
+       thread_count - 0 - hardware concurrency */
+    void BuildBusInfos(size_t thread_count = 0);
+
+    /* Get precomputed Bus infos, index = bus id, empty if not built */
+    const std::vector<BusInfo>& GetBusInfos() const;
+
+    /* Load precomputed Bus infos after Buses are added */
+    void LoadBusInfos(std::vector<BusInfo>&& bus_infos);
+
+    /* Get names of Stops and Buses. Names of removed Buses are kept */
+    const StringPool& GetNames() const;
+
+    /* Load names pool before Stops and Buses are added, their names are found in it */
+    void LoadNames(const std::string_view blob, const std::vector<uint32_t>& offsets);
+
     /* Get Distances container */
-    const std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopHasher>&
-    GetDistances() const;
+    const DistanceTable& GetDistances() const;
+
+    /* Build spatial index over Stops coordinates. Index is dropped when Stops are added */
+    void BuildSpatialIndex();
+
+    /* Get spatial index, not built if IsBuilt() is false */
+    const SpatialIndex& GetSpatialIndex() const;
+
+    /* Load spatial index after Stops are added */
+    void LoadSpatialIndex(SpatialIndex::Data&& data);
+
+    /* Stops not farther than radius meters from center, at most count nearest of them (0 - no limit),
+       with distances in order of distance. Throws std::logic_error if spatial index is not built */
+    std::vector<std::pair<const Stop*, double>>
+    FindNearbyStops(geo::Coordinates center, size_t count, double radius = SpatialIndex::NO_RADIUS) const;
+
+    /* Build index of Stop and Bus names. Stops are weighted by number of buses passing them,
+       Buses by number of unique stops. Index is dropped when Stops or Buses are changed */
+    void BuildNameIndex();
+
+    /* Get name index, not built if IsBuilt() is false */
+    const NameIndex& GetNameIndex() const;
+
+    /* Load name index after Stops and Buses are added */
+    void LoadNameIndex(NameIndex::Data&& data);
+
+    /* At most count names (0 - no limit) of Stops and Buses having a prefix within max_distance edits
+       from query, closest and then heaviest first. Throws std::logic_error if name index is not built */
+    std::vector<NameSuggestion> SuggestNames(const std::string_view query, size_t count, size_t max_distance = 0) const;
 
 private:
+    BusInfo ComputeBusInfo(const Bus& bus) const;
+    void UpdateStopIndex();
+
+    StringPool names_;                                                  /* names of stops and buses */
     std::deque<Stop> stops_;                                            /* all bus stops for all buses */
     std::deque<Bus> buses_;                                             /* all buses routes */
     std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;/* fast access to stops by stop name */
-    std::unordered_map<size_t, const Stop*> stop_id_to_stop_;/* fast access to stops by stop id */
+    std::vector<const Stop*> stop_id_to_stop_;                          /* index = stop id, nullptr if no such stop */
     std::unordered_map<std::string_view, const Bus*> busname_to_bus_;   /* fast access to buses by bus name */
-    std::unordered_map<size_t, const Bus*> bus_id_to_bus_;   /* fast access to buses by bus id */
-    std::unordered_map<std::string_view, std::unordered_set<std::string_view>> stop_to_buses_; /* fast access to buses at the stop */
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopHasher> distances_; /* known real distances between stops */
-
-    static size_t stop_id_;
-    static size_t bus_id_;
+    std::vector<const Bus*> bus_id_to_bus_;                             /* index = bus id, nullptr if no such bus */
+    /* stop-to-buses index: names of buses passing stop with id i = stop_buses_[offsets[i], offsets[i + 1]) */
+    std::vector<size_t> stop_buses_offsets_;
+    std::vector<std::string_view> stop_buses_;
+    bool is_stop_index_built_ = false;
+    DistanceTable distances_;                                           /* known real distances between stops */
+    std::vector<BusInfo> bus_infos_;                                    /* index = bus id, empty if not built */
+    SpatialIndex stops_grid_;                                           /* spatial index over stops */
+    NameIndex name_index_;                                              /* trie of stop and bus names */
+
+    size_t next_stop_id_ = 0;                                           /* id of next added stop */
+    size_t next_bus_id_ = 0;                                            /* id of next added bus */
 };
 
-inline size_t TransportCatalogue::stop_id_ = 0;
-inline size_t TransportCatalogue::bus_id_ = 0;
-
 namespace detail {
 
 /* Delete leading and trailing whitespaces, but keep whitespaces inside */
@@ -1,6 +1,8 @@
 #include "transport_router.h"
 
+#include <algorithm>
 #include <deque>
+#include <limits>
 
 #include "graph.h"
 
@@ -45,7 +47,7 @@ vector<pair<graph::VertexId, double>> TransportRouter::TraceBus(const domain::Bu
     if (bus.type == domain::BusType::LINEAR) {
         // go backward if bus type linear
         for (auto it1 = bus.stops.rbegin(), it2 = it1 + 1; it2 != bus.stops.rend(); ++it1, ++it2) {
-            double distance = request_handler_.GetDistance((*it1)->name, (*it2)->name);
+            double distance = request_handler_.GetDistance((*it1)->id, (*it2)->id);
             if (distance == 0) distance = geo::ComputeDistance((*it1)->coordinates, (*it2)->coordinates);
             double time = distance / bus_velocity_;
             stop_id = (*it2)->id;
@@ -55,63 +57,400 @@ vector<pair<graph::VertexId, double>> TransportRouter::TraceBus(const domain::Bu
     return result;
 }
 
-void TransportRouter::Initialize() {
-    // buld the Graph
+/* Direct model: edge from every stop of bus to every next stop (wait time included) */
+void TransportRouter::AddBusEdges(DirectedWeightedGraph<EdgeWeight>& graph, const domain::Bus& bus) {
+    vector<pair<graph::VertexId, double>> trace = TraceBus(bus);
+
+    // make edges
+    for (auto it1 = trace.begin(); it1 + 1 != trace.end(); ++it1) {
+        double total_time = 0;
+        int stops_number = 0;
+        for (auto it2 = it1 + 1; it2 != trace.end(); ++it2) {
+            total_time += it2->second;
+            ++stops_number;
+            graph.AddEdge(
+                graph::Edge<EdgeWeight>{it1->first,
+                                        it2->first,
+                                        EdgeWeight{total_time + settings_.bus_wait_time,
+                                                   stops_number,
+                                                   bus.id}});
+        }
+    }
+}
+
+/* Direct model: vertex = stop */
+DirectedWeightedGraph<EdgeWeight> TransportRouter::BuildDirectGraph() {
     size_t vertexes_count = request_handler_.GetAllStops().size();
-    ptr_graph_ = make_unique<Graph>(vertexes_count);    // initialize with number of vertexes in graph
+    graph::DirectedWeightedGraph<EdgeWeight> graph(vertexes_count);    // initialize with number of vertexes in graph
     
     for (const auto& bus : request_handler_.GetAllBuses()) {
-        vector<pair<graph::VertexId, double>> trace = TraceBus(bus);
-
-        // make edges
-        for (auto it1 = trace.begin(); it1 + 1 != trace.end(); ++it1) {
-            double total_time = 0;
-            int stops_number = 0;
-            for (auto it2 = it1 + 1; it2 != trace.end(); ++it2) {
-                total_time += it2->second;
-                ++stops_number;
-                ptr_graph_->AddEdge(
-                    graph::Edge<EdgeWeight>{it1->first,
-                                            it2->first,
-                                            EdgeWeight{total_time + settings_.bus_wait_time,
-                                                       stops_number,
-                                                       bus.id}});
+        AddBusEdges(graph, bus);
+    }
+    return graph;
+}
+
+/* Transfer model: vertexes [0, stops count) are stops, the rest are on-bus vertexes,
+ * one per stop of bus trace. Each on-bus vertex has boarding edge from its stop (wait time),
+ * ride edge from previous on-bus vertex (travel time, 1 stop) and alighting edge to its stop (zero time).
+ */
+DirectedWeightedGraph<EdgeWeight> TransportRouter::BuildTransferGraph() {
+    const size_t stops_count = request_handler_.GetAllStops().size();
+
+    vector<vector<pair<graph::VertexId, double>>> traces;
+    size_t vertexes_count = stops_count;
+    for (const auto& bus : request_handler_.GetAllBuses()) {
+        traces.push_back(TraceBus(bus));
+        vertexes_count += traces.back().size();
+    }
+
+    graph::DirectedWeightedGraph<EdgeWeight> graph(vertexes_count);
+    graph::VertexId on_bus_vertex = stops_count;
+    auto trace = traces.begin();
+    for (const auto& bus : request_handler_.GetAllBuses()) {
+        for (size_t i = 0; i < trace->size(); ++i, ++on_bus_vertex) {
+            const auto [stop_vertex, travel_time] = (*trace)[i];
+            if (i + 1 < trace->size()) {    // boarding
+                graph.AddEdge({stop_vertex, on_bus_vertex,
+                               EdgeWeight{static_cast<double>(settings_.bus_wait_time), 0, bus.id}});
+            }
+            if (i > 0) {                    // ride from previous stop and alighting
+                graph.AddEdge({on_bus_vertex - 1, on_bus_vertex, EdgeWeight{travel_time, 1, bus.id}});
+                graph.AddEdge({on_bus_vertex, stop_vertex, EdgeWeight{0, 0, bus.id}});
+            }
+        }
+        ++trace;
+    }
+    return graph;
+}
+
+void TransportRouter::Initialize() {
+    // buld the Graph and freeze it to CSR layout
+    if (settings_.router_type == RouterType::RAPTOR) {
+        ptr_graph_ = make_unique<Graph>(0);     // routes are searched on bus traces, graph is empty
+    } else if (settings_.graph_model == GraphModel::TRANSFER) {
+        ptr_graph_ = make_unique<Graph>(BuildTransferGraph());
+    } else {
+        ptr_graph_ = make_unique<Graph>(BuildDirectGraph());
+    }
+
+    InitializeRouter();
+    InitializeSearches();
+}
+
+void TransportRouter::UpdateBuses(const unordered_set<size_t>& bus_ids) {
+    if (!ptr_graph_) {
+        Initialize();
+        return;
+    }
+    if (settings_.graph_model == GraphModel::TRANSFER || settings_.router_type == RouterType::RAPTOR) {
+        // transfer model vertexes depend on all buses, RAPTOR has no graph to patch
+        Reset();
+        Initialize();
+        return;
+    }
+
+    // keep edges of unchanged buses, then add edges of changed ones
+    const Graph& old_graph = *ptr_graph_;
+    graph::DirectedWeightedGraph<EdgeWeight> graph(old_graph.GetVertexCount());
+    vector<EdgeId> edge_id_map(old_graph.GetEdgeCount(), graph::min_plus::NO_EDGE);
+    for (EdgeId edge_id = 0; edge_id < old_graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = old_graph.GetEdge(edge_id);
+        if (bus_ids.count(edge.weight.bus_id) == 0) {
+            edge_id_map[edge_id] = graph.AddEdge(edge);
+        }
+    }
+    const size_t kept_edge_count = graph.GetEdgeCount();
+    for (const size_t bus_id : bus_ids) {
+        if (const domain::Bus* bus = request_handler_.FindBus(bus_id)) {
+            AddBusEdges(graph, *bus);
+        }
+    }
+
+    // freeze and renumber edges to CSR ids
+    vector<EdgeId> csr_edge_ids;
+    Graph new_graph(graph, csr_edge_ids);
+    for (EdgeId& edge_id : edge_id_map) {
+        if (edge_id != graph::min_plus::NO_EDGE) edge_id = csr_edge_ids[edge_id];
+    }
+    const vector<EdgeId> added_edges(csr_edge_ids.begin() + kept_edge_count, csr_edge_ids.end());
+    *ptr_graph_ = move(new_graph);      // routers keep reference to the graph object
+
+    if (settings_.router_type == RouterType::ALL_PAIRS) {
+        ptr_router_->UpdateRoutes(edge_id_map, added_edges, settings_.thread_count,
+                                  settings_.routes_table_algorithm);
+    } else {
+        // only routes table is repaired incrementally. CH shortcuts, hub labels and ALT landmarks
+        // are rebuilt from scratch over the patched graph, DIJKSTRA and LAZY just start with empty cache
+        InitializeRouter();
+    }
+    InitializeSearches();
+}
+
+/* construct router of selected type from Graph */
+void TransportRouter::InitializeRouter() {
+    switch (settings_.router_type) {
+        case RouterType::DIJKSTRA :
+            ptr_dijkstra_router_ = make_unique<DijkstraRouter>(*ptr_graph_, settings_.route_cache_size);
+            break;
+        case RouterType::CONTRACTION_HIERARCHY :
+            ptr_contraction_hierarchy_ = make_unique<ContractionHierarchy>(*ptr_graph_);
+            break;
+        case RouterType::A_STAR :
+            ptr_a_star_router_ = make_unique<AStarRouter>(*ptr_graph_, settings_.landmark_count, MakeGeoHeuristic());
+            break;
+        case RouterType::HUB_LABELS :
+            ptr_hub_labels_ = make_unique<HubLabels>(*ptr_graph_);
+            break;
+        case RouterType::LAZY :
+            ptr_lazy_router_ = make_unique<LazyRouter>(*ptr_graph_, settings_.route_memory_limit << 20);
+            break;
+        case RouterType::RAPTOR : {
+            // bus traces with travel times prefix sums
+            vector<RaptorRouter::BusTrace> traces;
+            for (const auto& bus : request_handler_.GetAllBuses()) {
+                RaptorRouter::BusTrace trace{bus.id, {}, {}};
+                double time = 0;
+                for (const auto& [stop_id, travel_time] : TraceBus(bus)) {
+                    time += travel_time;
+                    trace.stops.push_back(stop_id);
+                    trace.times.push_back(time);
+                }
+                traces.push_back(move(trace));
             }
+            ptr_raptor_router_ = make_unique<RaptorRouter>(request_handler_.GetAllStops().size(),
+                                                           settings_.bus_wait_time, move(traces),
+                                                           settings_.max_transfers);
+            break;
         }
+        default :
+            ptr_router_ = make_unique<Router>(*ptr_graph_, settings_.thread_count,
+                                              settings_.routes_table_algorithm);
     }
+}
 
-    // construct Router from Graph
-    ptr_router_ = make_unique<Router>(*ptr_graph_);
+/* construct searches used besides the router: isochrones and one-to-many searches for engines
+   without routes table. They are built before queries, so queries don't change the router */
+void TransportRouter::InitializeSearches() {
+    ptr_isochrone_search_.reset(nullptr);
+    ptr_matrix_router_.reset(nullptr);
+    if (settings_.router_type == RouterType::RAPTOR) return;   // RAPTOR searches bus traces itself
+
+    ptr_isochrone_search_ = make_unique<IsochroneSearch>(*ptr_graph_);
+    if (settings_.router_type == RouterType::CONTRACTION_HIERARCHY || settings_.router_type == RouterType::A_STAR) {
+        ptr_matrix_router_ = make_unique<DijkstraRouter>(*ptr_graph_, 0);
+    }
 }
 
 void TransportRouter::Reset() {
+    ptr_isochrone_search_.reset(nullptr);
+    ptr_matrix_router_.reset(nullptr);
+    ptr_lazy_router_.reset(nullptr);
+    ptr_hub_labels_.reset(nullptr);
+    ptr_a_star_router_.reset(nullptr);
+    ptr_raptor_router_.reset(nullptr);
+    ptr_contraction_hierarchy_.reset(nullptr);
+    ptr_dijkstra_router_.reset(nullptr);
     ptr_router_.reset(nullptr);
     ptr_graph_.reset(nullptr);
 }
 
 const TransportRouter::InternalState TransportRouter::ExportInternalState() const {
-    return TransportRouter::InternalState{settings_, *ptr_graph_, *ptr_router_};
+    return TransportRouter::InternalState{settings_, *ptr_graph_, 
+                                          ptr_router_.get(), ptr_contraction_hierarchy_.get(),
+                                          ptr_a_star_router_.get(), ptr_hub_labels_.get()};
 }
 
 void TransportRouter::ExternalInitialization
-            (std::unique_ptr<Graph>&& graph, std::unique_ptr<Router>&& router) {
+            (std::unique_ptr<Graph>&& graph, std::unique_ptr<Router>&& router,
+             std::unique_ptr<ContractionHierarchy>&& contraction_hierarchy,
+             std::unique_ptr<AStarRouter>&& a_star_router,
+             std::unique_ptr<HubLabels>&& hub_labels) {
     ptr_graph_ = move(graph);
-    ptr_router_ = move(router);
+    switch (settings_.router_type) {
+        case RouterType::ALL_PAIRS :
+            ptr_router_ = move(router);
+            break;
+        case RouterType::CONTRACTION_HIERARCHY :
+            ptr_contraction_hierarchy_ = move(contraction_hierarchy);
+            break;
+        case RouterType::A_STAR :
+            ptr_a_star_router_ = move(a_star_router);
+            ptr_a_star_router_->SetHeuristic(MakeGeoHeuristic());
+            break;
+        case RouterType::HUB_LABELS :
+            ptr_hub_labels_ = move(hub_labels);
+            break;
+        default :
+            InitializeRouter();     // router state is not stored for other router types
+    }
+    InitializeSearches();
 }
 
-Route TransportRouter::GetRoute(const string& from, const string& to) {
+/* A* heuristic: geographic distance over max velocity (plus wait time if the route needs a bus
+ * boarding in DIRECT model). Road distances may be shorter than geographic ones, so max velocity
+ * is taken over all bus segments and the bound never overestimates travel time.
+ */
+TransportRouter::AStarRouter::Heuristic TransportRouter::MakeGeoHeuristic() {
+    const size_t stops_count = request_handler_.GetAllStops().size();
+    vertex_coordinates_.assign(stops_count, {});
+    for (const auto& stop : request_handler_.GetAllStops()) {
+        vertex_coordinates_[stop.id] = stop.coordinates;
+    }
 
-    if (!ptr_router_) Initialize();
-    
+    // TRANSFER model on-bus vertexes follow stop vertexes in the same order as in BuildTransferGraph
+    double min_time_per_meter = numeric_limits<double>::infinity();
+    for (const auto& bus : request_handler_.GetAllBuses()) {
+        const vector<pair<graph::VertexId, double>> trace = TraceBus(bus);
+        for (size_t i = 0; i < trace.size(); ++i) {
+            if (settings_.graph_model == GraphModel::TRANSFER) {
+                vertex_coordinates_.push_back(vertex_coordinates_[trace[i].first]);
+            }
+            if (i == 0) continue;
+            const double distance = geo::ComputeDistance(vertex_coordinates_[trace[i - 1].first],
+                                                         vertex_coordinates_[trace[i].first]);
+            if (distance > 0) min_time_per_meter = min(min_time_per_meter, trace[i].second / distance);
+        }
+    }
+    max_velocity_ = 1. / min_time_per_meter;
+
+    const double wait_time = (settings_.graph_model == GraphModel::DIRECT) ? settings_.bus_wait_time : 0;
+    return [this, wait_time](VertexId from, VertexId to) {
+        if (from == to) return 0.;
+        const double distance = geo::ComputeDistance(vertex_coordinates_[from], vertex_coordinates_[to]);
+        return wait_time + (distance > 0 ? distance / max_velocity_ : 0.);
+    };
+}
+
+optional<TransportRouter::Router::RouteInfo>
+TransportRouter::BuildRoute(VertexId from, VertexId to) const {
+    switch (settings_.router_type) {
+        case RouterType::DIJKSTRA :
+            return ptr_dijkstra_router_->BuildRoute(from, to);
+        case RouterType::CONTRACTION_HIERARCHY :
+            return ptr_contraction_hierarchy_->BuildRoute(from, to);
+        case RouterType::A_STAR :
+            return ptr_a_star_router_->BuildRoute(from, to);
+        case RouterType::HUB_LABELS :
+            return ptr_hub_labels_->BuildRoute(from, to);
+        case RouterType::LAZY :
+            return ptr_lazy_router_->BuildRoute(from, to);
+        default :
+            return ptr_router_->BuildRoute(from, to);
+    }
+}
+
+Route TransportRouter::GetRoute(const string& from, const string& to) const {
     VertexId vertex_from = request_handler_.FindStop(from)->id;
     VertexId vertex_to = request_handler_.FindStop(to)->id;
 
-    auto info = ptr_router_->BuildRoute(vertex_from, vertex_to);
+    if (settings_.router_type == RouterType::RAPTOR) {
+        return MakeRaptorRoute(ptr_raptor_router_->BuildRoute(vertex_from, vertex_to));
+    }
+    return MakeRoute(BuildRoute(vertex_from, vertex_to));
+}
+
+RouteMatrix TransportRouter::GetRouteMatrix(const vector<string>& from, const vector<string>& to) const {
+    // unknown destinations are replaced by vertex 0, their routes are reset after search
+    vector<VertexId> to_vertexes;
+    vector<bool> is_known_to;
+    to_vertexes.reserve(to.size());
+    for (const string& name : to) {
+        const domain::Stop* stop = request_handler_.FindStop(name);
+        is_known_to.push_back(stop != nullptr);
+        to_vertexes.push_back(stop ? stop->id : 0);
+    }
+
+    RouteMatrix result(from.size());
+    unordered_map<string_view, size_t> origin_rows;     /* origin name, row with its routes */
+    for (size_t row = 0; row < from.size(); ++row) {
+        if (auto it = origin_rows.find(from[row]); it != origin_rows.end()) {
+            result[row] = result[it->second];
+            continue;
+        }
+        origin_rows.emplace(from[row], row);
+
+        const domain::Stop* stop = request_handler_.FindStop(from[row]);
+        if (!stop) {
+            result[row].resize(to.size());
+            continue;
+        }
+        result[row] = GetRoutesFrom(stop->id, to_vertexes);
+        for (size_t column = 0; column < to.size(); ++column) {
+            if (!is_known_to[column]) result[row][column].reset();
+        }
+    }
+    return result;
+}
+
+/* Bounded one-to-all search. RAPTOR prunes arrivals later than limit,
+ * other engines run bucket queue search on the graph */
+ReachableStops TransportRouter::GetReachableStops(const string& from, double time_limit) const {
+    const domain::Stop* stop = request_handler_.FindStop(from);
+    if (!stop) return nullopt;
+
+    vector<pair<VertexId, double>> reached;
+    if (settings_.router_type == RouterType::RAPTOR) {
+        reached = ptr_raptor_router_->FindReachable(stop->id, time_limit);
+    } else {
+        reached = ptr_isochrone_search_->FindReachable(stop->id, time_limit);
+    }
 
+    // transfer model on-bus vertexes follow stop vertexes
+    const size_t stops_count = request_handler_.GetAllStops().size();
+    vector<ReachableStop> result;
+    for (const auto& [vertex, time] : reached) {
+        if (vertex < stops_count) {
+            result.push_back(ReachableStop{request_handler_.FindStop(vertex)->name, time});
+        }
+    }
+    // equal times are ordered by name
+    sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.stop < rhs.stop);
+    });
+    return result;
+}
+
+/* Routes from one vertex to many. All-pairs table and hub labels are looked up directly,
+ * RAPTOR runs one search to all stops, other engines use one shortest-path tree */
+vector<Route> TransportRouter::GetRoutesFrom(VertexId from, const vector<VertexId>& to) const {
+    vector<Route> routes;
+    routes.reserve(to.size());
+
+    if (settings_.router_type == RouterType::RAPTOR) {
+        for (const auto& info : ptr_raptor_router_->BuildRoutes(from, to)) {
+            routes.push_back(MakeRaptorRoute(info));
+        }
+        return routes;
+    }
+    if (settings_.router_type == RouterType::ALL_PAIRS || settings_.router_type == RouterType::HUB_LABELS
+        || settings_.router_type == RouterType::LAZY) {
+        for (const VertexId vertex_to : to) {
+            routes.push_back(MakeRoute(BuildRoute(from, vertex_to)));
+        }
+        return routes;
+    }
+
+    const DijkstraRouter& router = ptr_dijkstra_router_ ? *ptr_dijkstra_router_ : *ptr_matrix_router_;
+    for (const auto& info : router.BuildRoutes(from, to)) {
+        routes.push_back(MakeRoute(info));
+    }
+    return routes;
+}
+
+Route TransportRouter::MakeRoute(const optional<Router::RouteInfo>& info) const {
     if (!info) return {};
 
+    vector<RouteItem> items = (settings_.graph_model == GraphModel::TRANSFER)
+                              ? MakeTransferRouteItems(info->edges)
+                              : MakeDirectRouteItems(info->edges);
+
+    return RouteItems{info->weight.total_time, move(items)};
+}
+
+/* Direct model: every edge is a single bus trip */
+vector<RouteItem> TransportRouter::MakeDirectRouteItems(const vector<EdgeId>& edges) const {
     vector<RouteItem> items;
-    for (const auto& edge_id : info->edges) {
+    for (const auto& edge_id : edges) {
         const Edge<EdgeWeight>& edge = ptr_graph_->GetEdge(edge_id);
         items.push_back(RouteItem{string_view{request_handler_.FindStop(edge.from)->name},
                                   string_view{request_handler_.FindStop(edge.to)->name},
@@ -120,8 +459,49 @@ Route TransportRouter::GetRoute(const string& from, const string& to) {
                                   static_cast<double>(settings_.bus_wait_time),
                                   edge.weight.total_time - settings_.bus_wait_time});
     }
-    
-    return RouteItems{info->weight.total_time, move(items)};
+    return items;
+}
+
+/* Transfer model: bus trip is boarding edge, ride edges and alighting edge.
+ * Ride edges are merged into trip span count and travel time.
+ */
+vector<RouteItem> TransportRouter::MakeTransferRouteItems(const vector<EdgeId>& edges) const {
+    const size_t stops_count = request_handler_.GetAllStops().size();
+    vector<RouteItem> items;
+    for (const auto& edge_id : edges) {
+        const Edge<EdgeWeight>& edge = ptr_graph_->GetEdge(edge_id);
+        if (edge.from < stops_count) {          // boarding
+            items.push_back(RouteItem{string_view{request_handler_.FindStop(edge.from)->name},
+                                      {},
+                                      string_view{request_handler_.FindBus(edge.weight.bus_id)->name},
+                                      0,
+                                      edge.weight.total_time,
+                                      0});
+        } else if (edge.to < stops_count) {     // alighting
+            items.back().to_stop = string_view{request_handler_.FindStop(edge.to)->name};
+        } else {                                // ride
+            items.back().span_count += edge.weight.stops_number;
+            items.back().travel_time += edge.weight.total_time;
+        }
+    }
+    return items;
+}
+
+/* RAPTOR router returns bus trips directly */
+Route TransportRouter::MakeRaptorRoute(const optional<RaptorRouter::RouteInfo>& info) const {
+    if (!info) return {};
+
+    vector<RouteItem> items;
+    for (const auto& trip : info->trips) {
+        items.push_back(RouteItem{string_view{request_handler_.FindStop(trip.from)->name},
+                                  string_view{request_handler_.FindStop(trip.to)->name},
+                                  string_view{request_handler_.FindBus(trip.bus_id)->name},
+                                  trip.span_count,
+                                  static_cast<double>(settings_.bus_wait_time),
+                                  trip.travel_time});
+    }
+
+    return RouteItems{info->total_time, move(items)};
 }
 
 bool operator<(const EdgeWeight& lhs, const EdgeWeight& rhs) {
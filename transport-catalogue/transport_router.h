@@ -5,12 +5,20 @@
 #include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <optional>
 
 #include "request_handler.h"
 #include "graph.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "astar_router.h"
+#include "hub_labels.h"
+#include "lazy_router.h"
+#include "raptor_router.h"
+#include "isochrone.h"
 
 namespace transport_catalogue {
 
@@ -35,6 +43,18 @@ struct RouteItems {
 /* Route */
 using Route = std::optional<RouteItems>;
 
+/* Routes between lists of stops, index = [from stop index][to stop index] */
+using RouteMatrix = std::vector<std::vector<Route>>;
+
+/* Stop reachable within time limit */
+struct ReachableStop {
+    std::string_view stop;
+    double time;                /* minutes from origin stop */
+};
+
+/* Reachable stops in order of time, nullopt for unknown origin */
+using ReachableStops = std::optional<std::vector<ReachableStop>>;
+
 /* Route edge, contains weight and route info. */
 struct EdgeWeight {
     double total_time;          /* edge time, minutes */
@@ -46,32 +66,100 @@ bool operator<(const EdgeWeight& lhs, const EdgeWeight& rhs);
 bool operator>(const EdgeWeight& lhs, const EdgeWeight& rhs);
 EdgeWeight operator+(const EdgeWeight& lhs, const EdgeWeight& rhs);
 
+} // namespace transport_router
+
+} // namespace transport_catalogue
+
+/* Edge weights are ordered by total time only */
+template <>
+struct graph::WeightTraits<transport_catalogue::transport_router::EdgeWeight> {
+    static constexpr bool HAS_SCALAR_KEY = true;
+    static double GetKey(const transport_catalogue::transport_router::EdgeWeight& weight) {
+        return weight.total_time;
+    }
+    static void SetKey(transport_catalogue::transport_router::EdgeWeight& weight, double key) {
+        weight.total_time = key;
+    }
+};
+
+namespace transport_catalogue {
+
+namespace transport_router {
+
+/* Route search engine */
+enum class RouterType {
+    ALL_PAIRS,      /* all-pairs routes table precomputed at make_base */
+    DIJKSTRA,       /* on-demand Dijkstra with cache of shortest-path trees */
+    CONTRACTION_HIERARCHY,  /* contraction hierarchies, shortcuts precomputed at make_base */
+    RAPTOR,         /* round-based scan of bus traces, no graph */
+    A_STAR,         /* A* with geographic heuristic and optional ALT landmarks precomputed at make_base */
+    HUB_LABELS,     /* hub labels (2-hop cover) precomputed at make_base */
+    LAZY            /* all-pairs routes table filled row by row on demand */
+};
+
+/* Routes graph layout */
+enum class GraphModel {
+    DIRECT,         /* stop vertices only, edge from every stop to every next stop of bus, O(n^2) edges per bus */
+    TRANSFER        /* stop and on-bus vertices: boarding, ride and alighting edges, O(n) edges per bus */
+};
+
 class TransportRouter {
 public:
     struct Settings {
         double bus_velocity;    /* bus velocity, km/h */
         int bus_wait_time;      /* wait time for bus on stop, minutes */
+        RouterType router_type = RouterType::ALL_PAIRS;
+        size_t route_cache_size = 128;  /* max cached shortest-path trees for DIJKSTRA router */
+        size_t thread_count = 0;        /* threads for routes precomputation, 0 - hardware concurrency */
+        GraphModel graph_model = GraphModel::DIRECT;
+        size_t landmark_count = 0;      /* ALT landmarks for A_STAR router, 0 - geographic heuristic only */
+        size_t route_memory_limit = 0;  /* stored routes rows of LAZY router, megabytes, 0 - no limit */
+        graph::RoutesTableAlgorithm routes_table_algorithm = graph::RoutesTableAlgorithm::FLOYD_WARSHALL;
+                                        /* routes precomputation of ALL_PAIRS router */
+        std::optional<size_t> max_transfers;    /* bus changes on route for RAPTOR router, nullopt - no limit */
     };
 
-    using Graph = graph::DirectedWeightedGraph<EdgeWeight>;
+    using Graph = graph::CsrGraph<EdgeWeight>;          /* frozen graph used by routers */
     using Router = graph::Router<EdgeWeight>;
+    using DijkstraRouter = graph::DijkstraRouter<EdgeWeight>;
+    using ContractionHierarchy = graph::ContractionHierarchy<EdgeWeight>;
+    using AStarRouter = graph::AStarRouter<EdgeWeight>;
+    using HubLabels = graph::HubLabels<EdgeWeight>;
+    using LazyRouter = graph::LazyRouter<EdgeWeight>;
+    using IsochroneSearch = graph::IsochroneSearch<EdgeWeight>;
 
     explicit TransportRouter(RequestHandler& request_handler);
 
     void SetSettings(Settings&& settings);
-    Route GetRoute(const std::string& from, const std::string& to);
+    /* Route searches need initialized router. They keep no state in the router,
+       so concurrent threads may query it without locks */
+    Route GetRoute(const std::string& from, const std::string& to) const;
+    /* One search per distinct origin stop. Unknown stops have no routes */
+    RouteMatrix GetRouteMatrix(const std::vector<std::string>& from, const std::vector<std::string>& to) const;
+    /* All stops reachable from stop within time limit, minutes */
+    ReachableStops GetReachableStops(const std::string& from, double time_limit) const;
 
     void Initialize();
     void Reset();
 
+    /* Patch graph edges of added, removed or changed buses. ALL_PAIRS routes table is repaired incrementally,
+       other engines are rebuilt over the patched graph. Stops must be the same as at initialization */
+    void UpdateBuses(const std::unordered_set<size_t>& bus_ids);
+
     struct InternalState {
         const Settings& settings;
         const Graph& graph;
-        const Router& router;
+        const Router* router;   /* nullptr if router type doesn't keep routes table */
+        const ContractionHierarchy* contraction_hierarchy;  /* nullptr if router type is not CH */
+        const AStarRouter* a_star_router;   /* nullptr if router type is not A_STAR */
+        const HubLabels* hub_labels;        /* nullptr if router type is not HUB_LABELS */
     };
 
     const InternalState ExportInternalState() const;
-    void ExternalInitialization(std::unique_ptr<Graph>&& graph, std::unique_ptr<Router>&& router);
+    void ExternalInitialization(std::unique_ptr<Graph>&& graph, std::unique_ptr<Router>&& router,
+                                std::unique_ptr<ContractionHierarchy>&& contraction_hierarchy,
+                                std::unique_ptr<AStarRouter>&& a_star_router,
+                                std::unique_ptr<HubLabels>&& hub_labels);
 
 private:
     RequestHandler& request_handler_;
@@ -80,8 +168,32 @@ private:
 
     std::unique_ptr<Graph> ptr_graph_;
     std::unique_ptr<Router> ptr_router_;
+    std::unique_ptr<DijkstraRouter> ptr_dijkstra_router_;
+    std::unique_ptr<ContractionHierarchy> ptr_contraction_hierarchy_;
+    std::unique_ptr<RaptorRouter> ptr_raptor_router_;
+    std::unique_ptr<AStarRouter> ptr_a_star_router_;
+    std::unique_ptr<HubLabels> ptr_hub_labels_;
+    std::unique_ptr<LazyRouter> ptr_lazy_router_;
+    std::unique_ptr<DijkstraRouter> ptr_matrix_router_;    /* one-to-many searches for CH and A_STAR route matrix */
+    std::unique_ptr<IsochroneSearch> ptr_isochrone_search_; /* bounded one-to-all searches */
+
+    /* A* heuristic data */
+    std::vector<geo::Coordinates> vertex_coordinates_;  /* index = vertex id */
+    double max_velocity_;       /* max ratio of geographic distance to travel time, meters/min */
 
     std::vector<std::pair<graph::VertexId, double>> TraceBus(const domain::Bus& bus);
+    void AddBusEdges(graph::DirectedWeightedGraph<EdgeWeight>& graph, const domain::Bus& bus);
+    graph::DirectedWeightedGraph<EdgeWeight> BuildDirectGraph();
+    graph::DirectedWeightedGraph<EdgeWeight> BuildTransferGraph();
+    void InitializeRouter();
+    void InitializeSearches();
+    AStarRouter::Heuristic MakeGeoHeuristic();
+    std::optional<Router::RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+    std::vector<RouteItem> MakeDirectRouteItems(const std::vector<graph::EdgeId>& edges) const;
+    std::vector<RouteItem> MakeTransferRouteItems(const std::vector<graph::EdgeId>& edges) const;
+    std::vector<Route> GetRoutesFrom(graph::VertexId from, const std::vector<graph::VertexId>& to) const;
+    Route MakeRoute(const std::optional<Router::RouteInfo>& info) const;
+    Route MakeRaptorRoute(const std::optional<RaptorRouter::RouteInfo>& info) const;
 };
 
 } // namespace transport_router